@@ -0,0 +1,93 @@
+#include "arclengthtable.h"
+
+ArcLengthTable::ArcLengthTable()
+{
+}
+
+void ArcLengthTable::build(QPointF qpfStart, QPointF qpfControl1, QPointF qpfControl2, QPointF qpfEnd, int iSamples)
+{
+    mqpfPoints[0] = qpfStart;
+    mqpfPoints[1] = qpfControl1;
+    mqpfPoints[2] = qpfControl2;
+    mqpfPoints[3] = qpfEnd;
+
+    iSamples = qMax(iSamples, 2);
+    mflLengths.resize(iSamples);
+    mflLengths[0] = 0;
+
+    // sum of the chords between samples - converges on the true length as the samples increase
+    QPointF qpfPrevious = qpfStart;
+    for (int iSample = 1; iSample < iSamples; iSample++)
+    {
+        QPointF qpfThis = getPointAtT(float(iSample) / (iSamples - 1));
+        QPointF qpfChord = qpfThis - qpfPrevious;
+        mflLengths[iSample] = mflLengths.at(iSample - 1) + qSqrt((qpfChord.x() * qpfChord.x()) + (qpfChord.y() * qpfChord.y()));
+        qpfPrevious = qpfThis;
+    }
+}
+
+void ArcLengthTable::clear()
+{
+    mflLengths.clear();
+}
+
+bool ArcLengthTable::isEmpty() const
+{
+    return mflLengths.isEmpty();
+}
+
+float ArcLengthTable::getLength() const
+{
+    if (mflLengths.isEmpty())
+        return 0;
+
+    return mflLengths.last();
+}
+
+QPointF ArcLengthTable::getPointAtDistance(float flDistance) const
+{
+    if (mflLengths.isEmpty())
+        return QPointF();
+
+    if (flDistance <= 0)
+        return mqpfPoints[0];
+    if (flDistance >= mflLengths.last())
+        return mqpfPoints[3];
+
+    // first sample at or beyond the distance, then interpolate t between it and the one before
+    QVector<float>::const_iterator itAfter = qLowerBound(mflLengths.constBegin(), mflLengths.constEnd(), flDistance);
+    int iAfter = qMax(int(itAfter - mflLengths.constBegin()), 1);
+    float flSegment = mflLengths.at(iAfter) - mflLengths.at(iAfter - 1);
+    float flIntoSegment = (flSegment > 0) ? (flDistance - mflLengths.at(iAfter - 1)) / flSegment : 0;
+
+    return getPointAtT((iAfter - 1 + flIntoSegment) / (mflLengths.size() - 1));
+}
+
+// fraction (0..1) of the way along the curve by distance, not by t
+QPointF ArcLengthTable::getPointAtFraction(float flFraction) const
+{
+    return getPointAtDistance(flFraction * getLength());
+}
+
+// points at equal distances along the curve, including both ends
+QList<QPointF> ArcLengthTable::getEvenSamples(int iCount) const
+{
+    QList<QPointF> qpflReturn;
+
+    if (mflLengths.isEmpty())
+        return qpflReturn;
+
+    iCount = qMax(iCount, 2);
+    for (int iSample = 0; iSample < iCount; iSample++)
+        qpflReturn.append(getPointAtFraction(float(iSample) / (iCount - 1)));
+
+    return qpflReturn;
+}
+
+QPointF ArcLengthTable::getPointAtT(float flT) const
+{
+    float flU = 1 - flT;
+
+    return (flU * flU * flU * mqpfPoints[0]) + (3 * flU * flU * flT * mqpfPoints[1]) +
+           (3 * flU * flT * flT * mqpfPoints[2]) + (flT * flT * flT * mqpfPoints[3]);
+}
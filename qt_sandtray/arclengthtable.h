@@ -0,0 +1,33 @@
+#ifndef ARCLENGTHTABLE_H
+#define ARCLENGTHTABLE_H
+
+#include <QtCore>
+#include <QPointF>
+#include <qmath.h>
+
+const int _ARC_SAMPLES_ = 256;                      // samples along a cubic bezier for its arc length table
+
+// cubic bezier with a table of the distance travelled at evenly spaced t
+// lets a point be found by distance along the curve (binary search, O(log n)), so movement along it is at a constant speed
+class ArcLengthTable
+{
+public:
+    ArcLengthTable();
+
+    void build(QPointF qpfStart, QPointF qpfControl1, QPointF qpfControl2, QPointF qpfEnd, int iSamples = _ARC_SAMPLES_);
+    void clear();
+
+    bool isEmpty() const;
+    float getLength() const;
+    QPointF getPointAtDistance(float flDistance) const;
+    QPointF getPointAtFraction(float flFraction) const;
+    QList<QPointF> getEvenSamples(int iCount) const;
+
+private:
+    QPointF getPointAtT(float flT) const;
+
+    QPointF mqpfPoints[4];          // start, control points, end
+    QVector<float> mflLengths;      // arc length from the start to sample i, at t = i / (samples - 1)
+};
+
+#endif // ARCLENGTHTABLE_H
@@ -0,0 +1,81 @@
+#include "boardbuilder.h"
+
+// sized up front, so adding each item is an append without reallocating
+BoardBuilder::BoardBuilder(QSize qsScreen, int iTotalCats, int iTotalImgs)
+{
+    mCategories.reserve(iTotalCats);
+    mImageHot.qpfPositions.reserve(iTotalImgs);
+    mImageHot.qsSizes.reserve(iTotalImgs);
+    mImageHot.bOwned.reserve(iTotalImgs);
+    mImageHot.bActive.reserve(iTotalImgs);
+    mImageHot.bRobotMoving.reserve(iTotalImgs);
+    mImageCold.reserve(iTotalImgs);
+
+    // same area as gameData's own grids - scene origin is the centre of the screen
+    QRect rScreen(-qsScreen.width() / 2, -qsScreen.height() / 2, qsScreen.width(), qsScreen.height());
+    mCategoryGrid.setBounds(rScreen);
+    mImageGrid.setBounds(rScreen);
+}
+
+void BoardBuilder::addCategory(const GameData::CategoryDetails &category)
+{
+    mCategories.append(category);
+    mCategoryGrid.insert(category.catId, SpatialGrid::boundsAround(category.qpfCatPosition, category.qsCatSize));
+}
+
+// split into the hot arrays and cold table the same way gameData keeps them
+void BoardBuilder::addImage(const GameData::ImageDetails &image)
+{
+    mImageHot.qpfPositions.append(image.qpfImagePosition);
+    mImageHot.qsSizes.append(image.qsImageSize);
+    mImageHot.bOwned.append(image.imageOwned);
+    mImageHot.bActive.append(image.imageActive);
+    mImageHot.bRobotMoving.append(image.bRobotMoving);
+
+    GameData::ImageColdDetails cold;
+    cold.imageId = image.imageId;
+    cold.imageProps = image.imageProps;
+    cold.catBelonged = image.catBelonged;
+    cold.ppBezier = image.ppBezier;
+    cold.qpflBezPoints = image.qpflBezPoints;
+    cold.bRobotLastOwner = image.bRobotLastOwner;
+    cold.iRobotMoveTime = image.iRobotMoveTime;
+    cold.catPlaced = image.catPlaced;
+    cold.bGreenBorder = image.bGreenBorder;
+    mImageCold.append(cold);
+
+    mImageGrid.insert(image.imageId, SpatialGrid::boundsAround(image.qpfImagePosition, image.qsImageSize));
+}
+
+void BoardBuilder::setCategoryPosition(int iCatId, QPointF qpfPosition)
+{
+    mCategories[iCatId].qpfCatPosition = qpfPosition;
+    mCategoryGrid.insert(iCatId, SpatialGrid::boundsAround(qpfPosition, mCategories.at(iCatId).qsCatSize));
+}
+
+void BoardBuilder::setImagePosition(int iImageId, QPointF qpfPosition)
+{
+    mImageHot.qpfPositions[iImageId] = qpfPosition;
+    mImageGrid.insert(iImageId, SpatialGrid::boundsAround(qpfPosition, mImageHot.qsSizes.at(iImageId)));
+}
+
+const QList<GameData::CategoryDetails> &BoardBuilder::getCategories() const
+{
+    return mCategories;
+}
+const GameData::ImageHotState &BoardBuilder::getImageHot() const
+{
+    return mImageHot;
+}
+const QVector<GameData::ImageColdDetails> &BoardBuilder::getImageCold() const
+{
+    return mImageCold;
+}
+const SpatialGrid &BoardBuilder::getCategoryGrid() const
+{
+    return mCategoryGrid;
+}
+const SpatialGrid &BoardBuilder::getImageGrid() const
+{
+    return mImageGrid;
+}
@@ -0,0 +1,36 @@
+#ifndef BOARDBUILDER_H
+#define BOARDBUILDER_H
+
+#include <QtGui>
+
+#include "gamedata.h"
+#include "spatialgrid.h"
+
+// the category and image tables for a new library, built up without gameData's lock and handed over whole by GameData::setBoard
+// items add themselves as they are created, in id order - positions can be set after
+class BoardBuilder
+{
+public:
+    BoardBuilder(QSize qsScreen, int iTotalCats, int iTotalImgs);
+
+    void addCategory(const GameData::CategoryDetails &category);
+    void addImage(const GameData::ImageDetails &image);
+
+    void setCategoryPosition(int iCatId, QPointF qpfPosition);
+    void setImagePosition(int iImageId, QPointF qpfPosition);
+
+    const QList<GameData::CategoryDetails> &getCategories() const;
+    const GameData::ImageHotState &getImageHot() const;
+    const QVector<GameData::ImageColdDetails> &getImageCold() const;
+    const SpatialGrid &getCategoryGrid() const;
+    const SpatialGrid &getImageGrid() const;
+
+private:
+    QList<GameData::CategoryDetails> mCategories;
+    GameData::ImageHotState mImageHot;
+    QVector<GameData::ImageColdDetails> mImageCold;
+    SpatialGrid mCategoryGrid;
+    SpatialGrid mImageGrid;
+};
+
+#endif // BOARDBUILDER_H
@@ -1,34 +1,33 @@
 #include "category.h"
 
-// construct the image data and add it to the gamedata currently used
-Category::Category(QString sFile, GameData &currData, int idIn)
+// construct the image data and add it to the board being built - the image comes already decoded, and its name parsed, from the library manager
+Category::Category(const LibraryIndex::ImageEntry &image, QImage qiImage, GameData &currData, BoardBuilder &board, int idIn)
 {
     mGameData = &currData;
     myListSlot = idIn;
 
-    QImage qiImage;
-    qiImage.load(sFile);
     mpxImage = QPixmap::fromImage(qiImage);
     miImageHeight = mpxImage.height();
     miImageWidth = mpxImage.width();
     miRungWidth = mGameData->getLadderWidth();
     miNumberOfRungs = mGameData->getLadderRungs();
     miRungHeight = miImageHeight / miNumberOfRungs;   // height of rung = height of im / num of rungs
+    mpxCorrectFeedback = scaleFeedback(mGameData->getCorrectFeedback());
+    mpxIncorrectFeedback = scaleFeedback(mGameData->getIncorrectFeedback());
 
     if (idIn % 2)
         msLadderSide = "R";     // id odd, so ladder on right
     else
         msLadderSide = "L";     // id even, so ladder left
 
-    QFileInfo fiImage(sFile);
-    fiImage.fileName();
+    mbLadderLeft = (msLadderSide == "L");
 
-    // create image struct and add it to the gamedata list of images
+    // create image struct and add it to the new board's categories
     GameData::CategoryDetails myDetails;
     myDetails.catId = myListSlot;
-    myDetails.catName = fiImage.fileName().mid(3,1).toUpper();  // first 3 are 'cat', next letter is name
+    myDetails.catName = image.sCategory;
     myDetails.qsCatSize = QSize(miImageWidth, miImageHeight);
-    myDetails.catProps = extractImageProps(fiImage);
+    myDetails.catProps = image.sProps;
     myDetails.qpfCatPosition = scenePos();
     myDetails.ladderSlots = miNumberOfRungs;
     myDetails.rungHeight = miRungHeight;
@@ -40,28 +39,32 @@ Category::Category(QString sFile, GameData &currData, int idIn)
     myDetails.bCorrectFeedback = false;
     myDetails.iFeedbackStart = 0;
 
-    mGameData->addCatDetails(myDetails);
+    board.addCategory(myDetails);
 
     setZValue(-1000);                                           // place at the back, so dragImages always go on top
-}
-
-// get the image properties from the filename - use underscore delimiter
-QString Category::extractImageProps(QFileInfo fiIm)
-{
-    QRegExp rx("(\\_|\\.)"); //RegEx for '.' or '_'
-    QStringList splitString = fiIm.fileName().split(rx);
 
-    splitString.removeAt(0);                    // remove cat/id at start
-    splitString.removeAt(splitString.count() - 1);  // remove file type at end
-
-    return splitString.join("_");
+    // the category and ladder never change, so render them once - as is, and faded for when an image overlaps
+    mbUseCache = mGameData->getCacheCategories();
+    if (mbUseCache)
+    {
+        mpxComposite = renderComposite(false);
+        mpxCompositeOverlap = renderComposite(true);
+    }
 }
 
 // get bounding rectange for image - works from top left, so to make image centre of the box
 // we need to multiply the image width and height by -0.5 to give the top left point
+// the ladder is drawn too, so it has to be inside the bounds (plus the pen) or it isn't redrawn when the category is
 QRectF Category::boundingRect() const
 {
-    return QRectF(miImageWidth * -0.5, miImageHeight * -0.5, miImageWidth, miImageHeight);
+    QRectF rBounds(miImageWidth * -0.5, miImageHeight * -0.5, miImageWidth, miImageHeight);
+
+    if (mbLadderLeft)
+        rBounds.setLeft(rBounds.left() - miRungWidth);
+    else
+        rBounds.setRight(rBounds.right() + miRungWidth);
+
+    return rBounds.adjusted(-2, -2, 2, 2);
 }
 
 // draws the category on screen - update to change appearance
@@ -70,8 +73,69 @@ void Category::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     Q_UNUSED(option);
     Q_UNUSED(widget);
 
+    // read everything from this frame's render state - no locking per item
+    const GameData::RenderState &render = mGameData->getRenderState();
+
+    if (myListSlot >= render.board.categories.size())
+        return;                                             // created since the frame started - painted next frame
+
+    const GameData::CategoryDetails &myDetails = render.board.categories.at(myListSlot);
+
+    if (mbUseCache)
+    {
+        painter->setOpacity(1.0);
+        painter->drawPixmap(boundingRect().topLeft(), myDetails.currOverlap ? mpxCompositeOverlap : mpxComposite);
+    }
+    else
+        paintCategoryAndLadder(painter, myDetails.currOverlap);
+
+    // if something has just been categorised, then overlay the feedback if turned on
+    if (render.bShowFeedback)
+    {
+        if (myDetails.bShowFeedback)
+        {
+            // only want to show for a short time
+            int iStart = myDetails.iFeedbackStart;
+            int iTimeNow = QDateTime::currentMSecsSinceEpoch();
+            int iDiff = iTimeNow - iStart;
+
+            // the start is defaulted to 0 - ignore if this is called before the value is updated
+            if (iStart != 0)
+            {
+                if (iDiff > 2000)
+                {
+                    mGameData->setShowCategoryFeedback(myListSlot, false);
+                    mGameData->setForceScreenUpdate(false);
+                }
+                else
+                {
+                    float flTransparency = 1;
+                    if (iDiff == 0)
+                        iDiff = 1;  // prevent division by 0
+
+                    if (iDiff <= 500)
+                        flTransparency = float(iDiff) / 500;
+
+                    if (iDiff >= 1500)
+                        flTransparency = float((2000 - iDiff)) / 500;
+
+                    painter->setOpacity(flTransparency);                                    // apply transparency to our overlay
+                    // draw the overlay - use centre as category centre
+                    if (myDetails.bCorrectFeedback)
+                        painter->drawPixmap(QPointF(miImageWidth * -0.5, miImageHeight * -0.5), mpxCorrectFeedback);
+                    else
+                        painter->drawPixmap(QPointF(miImageWidth * -0.5, miImageHeight * -0.5), mpxIncorrectFeedback);
+                }
+            }
+        }
+    }
+}
+
+// the static part of the category - its image (slightly transparent when there is an overlap) and the ladder
+void Category::paintCategoryAndLadder(QPainter *painter, bool bOverlap)
+{
     // make slightly transparent when there is an overlap
-    if (mGameData->getCurrOverlap(myListSlot))
+    if (bOverlap)
         painter->setOpacity(0.2);
     else
         painter->setOpacity(1.0);
@@ -89,7 +153,7 @@ void Category::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     int iImageB = iImageT + (miNumberOfRungs * miRungHeight);
     int iLineLeft, iLineRight;
 
-    if (msLadderSide == "L")
+    if (mbLadderLeft)
     {
         iLineLeft = iImageL - miRungWidth;
         iLineRight = iImageL;
@@ -109,58 +173,36 @@ void Category::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
         int iRungY = iImageT + (iCount * miRungHeight);
         painter->drawLine(QPointF(iLineLeft, iRungY), QPointF(iLineRight, iRungY));
     }
+}
 
-    // if something has just been categorised, then overlay the feedback if turned on
-    if (mGameData->getShowFeedback())
-    {
-        if (mGameData->getShowCategoryFeedback(myListSlot))
-        {
-            // only want to show for a short time
-            int iStart = mGameData->getFeedbackStart(myListSlot);
-            int iTimeNow = QDateTime::currentMSecsSinceEpoch();
-            int iDiff = iTimeNow - iStart;
-
-            // the start is defaulted to 0 - ignore if this is called before the value is updated
-            if (iStart != 0)
-            {
-                if (iDiff > 2000)
-                {
-                    mGameData->setShowCategoryFeedback(myListSlot, false);
-                    mGameData->setForceScreenUpdate(false);
-                }
-                else
-                {
-                    QPixmap* pixOverlay;
-                    if (mGameData->getIsFeedbackCorrect(myListSlot))
-                        pixOverlay = new QPixmap(mGameData->getCorrectFeedback());
-                    else
-                        pixOverlay = new QPixmap(mGameData->getIncorrectFeedback());
-
-                    float flHScale = pixOverlay->height() / float(miImageHeight);               // scale the image feedback so we can use any size going in
-                    float flWScale = pixOverlay->width() / float(miImageWidth);
+// category and ladder drawn into a pixmap the size of the bounds, to be blitted in paint
+QPixmap Category::renderComposite(bool bOverlap)
+{
+    QRectF rBounds = boundingRect();
+    QPixmap pxComposite(rBounds.size().toSize());
+    pxComposite.fill(Qt::transparent);
 
-                    if (flHScale > flWScale)
-                       *pixOverlay = pixOverlay->scaledToHeight(miImageHeight);
-                    else
-                       *pixOverlay = pixOverlay->scaledToWidth(miImageWidth);
+    QPainter compositePainter(&pxComposite);
+    compositePainter.translate(-rBounds.topLeft());
+    paintCategoryAndLadder(&compositePainter, bOverlap);
+    compositePainter.end();
 
-                    float flTransparency = 1;
-                    if (iDiff == 0)
-                        iDiff = 1;  // prevent division by 0
+    return pxComposite;
+}
 
-                    if (iDiff <= 500)
-                        flTransparency = float(iDiff) / 500;
+// scale the image feedback to fit the category so we can use any size going in - done once, not on every paint
+QPixmap Category::scaleFeedback(QPixmap pxFeedback)
+{
+    if (pxFeedback.isNull())
+        return pxFeedback;
 
-                    if (iDiff >= 1500)
-                        flTransparency = float((2000 - iDiff)) / 500;
+    float flHScale = pxFeedback.height() / float(miImageHeight);
+    float flWScale = pxFeedback.width() / float(miImageWidth);
 
-                    painter->setOpacity(flTransparency);                                    // apply transparency to our overlay
-                    painter->drawPixmap(QPointF(miImageWidth * -0.5, miImageHeight * -0.5), *pixOverlay);       // draw the overlay - use centre as category centre
-                    delete pixOverlay;
-                }
-            }
-        }
-    }
+    if (flHScale > flWScale)
+        return pxFeedback.scaledToHeight(miImageHeight);
+    else
+        return pxFeedback.scaledToWidth(miImageWidth);
 }
 
 // returns the top-left corner of the ladder
@@ -5,29 +5,40 @@
 #include <QtGui>
 
 #include "gamedata.h"
+#include "boardbuilder.h"
+#include "libraryindex.h"
 
 class Category : public QGraphicsItem
 {
 public:
-    Category(QString sFile, GameData &currData, int idIn);
+    Category(const LibraryIndex::ImageEntry &image, QImage qiImage, GameData &currData, BoardBuilder &board, int idIn);
 
     QRectF boundingRect() const;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
 
 private:
-    QString extractImageProps(QFileInfo fiIm);
     QPointF getLadderPosition();
+    QPixmap scaleFeedback(QPixmap pxFeedback);
+    void paintCategoryAndLadder(QPainter *painter, bool bOverlap);
+    QPixmap renderComposite(bool bOverlap);
 
     GameData* mGameData;
     int myListSlot;
 
     QPixmap mpxImage;
+    QPixmap mpxCorrectFeedback;     // feedback overlays, scaled to this category once when it is created
+    QPixmap mpxIncorrectFeedback;
     int miImageHeight;
     int miImageWidth;
     int miRungWidth;
     int miRungHeight;
     int miNumberOfRungs;
     QString msLadderSide;
+    bool mbLadderLeft;
+
+    bool mbUseCache;                // draw from the pre-rendered composites below - game/CacheCategories
+    QPixmap mpxComposite;           // category and ladder
+    QPixmap mpxCompositeOverlap;    // the same with the category faded, for when an image overlaps it
 };
 
 #endif
@@ -1,12 +1,4 @@
 #include "checkcategorisation.h"
-#include <QThread>
-
-class SleepThread : public QThread {
-public:
-   static inline void usleep(unsigned long usecs) {
-       QThread::usleep(usecs);
-   }
-};
 
 CheckCategorisation::CheckCategorisation(QGraphicsScene &sceneIn, GameData &dataIn)
 {
@@ -14,6 +6,10 @@ CheckCategorisation::CheckCategorisation(QGraphicsScene &sceneIn, GameData &data
     gameData = &dataIn;
 
     mbRun = true;
+    mStatsTimer = 0;
+    miPasses = 0;
+    miPassTimeNs = 0;
+    miMaxPassNs = 0;
 }
 
 CheckCategorisation::~CheckCategorisation()
@@ -21,104 +17,108 @@ CheckCategorisation::~CheckCategorisation()
     mbRun = false;
 }
 
+// passes are driven by GameData::boardChanged(), so the thread sleeps in its event loop while nothing on the table moves
 void CheckCategorisation::start()
 {
-    int imageL = 0, imageR = 0, imageT = 0, imageB = 0;           // dummy values so no overlaps can occur on first loop
-    int catL = 2000, catR = 2000, catT = 2000, catB = 2000;
-    SleepThread sl;
-    while(mbRun){
-        sl.usleep(1);
+    if (gameData->getPerformanceStats())
+    {
+        mStatsTimer = new QTimer(this);
+        connect(mStatsTimer, SIGNAL(timeout()), this, SLOT(reportStatistics()));
+        mStatsTimer->start(1000);
+        mStatsClock.start();
+    }
+
+    checkCollisions();      // pick up anything that changed before the thread was running
+}
+
+// one pass over the board - called whenever an image position, owner or active flag changes
+void CheckCategorisation::checkCollisions()
+{
+    gameData->clearCollisionRequest();      // anything changed from here on will queue another pass
+
+    if (mbRun)
+    {
         if (gameData->getCollisionCheck())
         {
-            // get lists of images and categories from gameData
-            QList<GameData::ImageDetails> allImages = gameData->getImageDetails();
+            QElapsedTimer passTimer;
+            passTimer.start();
+
+            // get the hot image arrays and categories from gameData - cold image details are only fetched on a categorisation
+            const GameData::ImageHotState hotImages = gameData->getImageHotState();
             QList<GameData::CategoryDetails> allCats = gameData->getCatDetails();
 
             foreach (GameData::CategoryDetails thisCat, allCats)
             {
-                // get bounds of categories
-                catL = thisCat.qpfCatPosition.x() - (thisCat.qsCatSize.width() / 2);
-                catR = thisCat.qpfCatPosition.x() + (thisCat.qsCatSize.width() / 2);
-                catT = thisCat.qpfCatPosition.y() - (thisCat.qsCatSize.height() / 2);
-                catB = thisCat.qpfCatPosition.y() + (thisCat.qsCatSize.height() / 2);
-
                 bool bCollisionThisCat = false;
 
-                // loop through each image and see if it has collided with a category
-                foreach (GameData::ImageDetails thisImage, allImages)
+                // only the images the spatial grid says overlap this category need looking at
+                foreach (int iThisImageId, gameData->getImagesOverlappingCategory(thisCat.catId))
                 {
-                    if(thisImage.imageActive)
+                    if (iThisImageId >= hotImages.bActive.size())
+                        continue;       // added after our copy was taken - the next pass will see it
+
+                    if(hotImages.bActive[iThisImageId])
                     {
-                        // get bounds of image (xleft, xright, ytop, ybottom)
-                        imageL = int(thisImage.qpfImagePosition.x()) - (thisImage.qsImageSize.width() / 2);
-                        imageR = int(thisImage.qpfImagePosition.x()) + (thisImage.qsImageSize.width() / 2);
-                        imageT = int(thisImage.qpfImagePosition.y()) - (thisImage.qsImageSize.height() / 2);
-                        imageB = int(thisImage.qpfImagePosition.y()) + (thisImage.qsImageSize.height() / 2);
-
-                        // check for overlap (proof by contradiction)
-                        if(imageL < catR && imageR > catL && imageT < catB && imageB > catT)
+                        if (hotImages.bOwned[iThisImageId])
                         {
-                            if (thisImage.imageOwned)
-                            {
-                                bCollisionThisCat = true;
-                            }
-                            else if (!thisImage.imageOwned)
+                            bCollisionThisCat = true;
+                        }
+                        else if (!hotImages.bOwned[iThisImageId])
+                        {
+                            int iThisCatId = thisCat.catId;
+                            bool bRobotLastOwner = gameData->getRobotOwned(iThisImageId);
+
+                            // not owned so it's been categorised; do something with the image
+                            gameData->setImageActive(iThisImageId, false);
+                            gameData->setCatPlaced(iThisImageId, iThisCatId);
+                            gameData->addInsideCategory(iThisCatId, iThisImageId);
+
+                            if (thisCat.catName == gameData->getCatBelonged(iThisImageId))
                             {
-                                int iThisImageId = thisImage.imageId;
-                                int iThisCatId = thisCat.catId;
+                                if (gameData->getUseSound() && gameData->getShowFeedback())
+                                    emit playSound(gameData->getRightSound());
 
-                                // not owned so it's been categorised; do something with the image
-                                gameData->setImageActive(iThisImageId, false);
-                                gameData->setCatPlaced(iThisImageId, iThisCatId);
-                                gameData->addInsideCategory(iThisCatId, iThisImageId);
+                                gameData->setIsFeedbackCorrect(iThisCatId, true);
 
-                                if (thisCat.catName == thisImage.catBelonged)
+                                if (bRobotLastOwner)
                                 {
-                                    if (gameData->getUseSound() && gameData->getShowFeedback())
-                                        emit playSound(gameData->getRightSound());
-
-                                    gameData->setIsFeedbackCorrect(iThisCatId, true);
-
-                                    if (thisImage.bRobotLastOwner)
-                                    {
-                                        gameData->setRobotMove(iThisImageId, true, iThisCatId);
-                                        gameData->setMsgToSend(_ROBOT_MOVE_);
-                                    }
-                                    else
-                                    {
-                                        gameData->setPlayerRightMove(iThisImageId, iThisCatId);
-                                        gameData->setMsgToSend(_PLAYER_MOVE_);
-                                    }
+                                    gameData->setRobotMove(iThisImageId, true, iThisCatId);
+                                    gameData->setMsgToSend(_ROBOT_MOVE_);
                                 }
                                 else
                                 {
-                                    if (gameData->getUseSound() && gameData->getShowFeedback())
-                                        emit playSound(gameData->getWrongSound());
-
-                                    gameData->setIsFeedbackCorrect(iThisCatId, false);
-
-                                    if (thisImage.bRobotLastOwner)
-                                    {
-                                        gameData->setRobotMove(iThisImageId, false, iThisCatId);
-                                        gameData->setMsgToSend(_ROBOT_MOVE_);
-                                    }
-                                    else
-                                    {
-                                        gameData->setPlayerWrongMove(thisImage.imageId, iThisCatId);
-                                        gameData->setMsgToSend(_PLAYER_MOVE_);
-                                    }
+                                    gameData->setPlayerRightMove(iThisImageId, iThisCatId);
+                                    gameData->setMsgToSend(_PLAYER_MOVE_);
                                 }
+                            }
+                            else
+                            {
+                                if (gameData->getUseSound() && gameData->getShowFeedback())
+                                    emit playSound(gameData->getWrongSound());
+
+                                gameData->setIsFeedbackCorrect(iThisCatId, false);
 
-                                if (gameData->getShowFeedback())
+                                if (bRobotLastOwner)
+                                {
+                                    gameData->setRobotMove(iThisImageId, false, iThisCatId);
+                                    gameData->setMsgToSend(_ROBOT_MOVE_);
+                                }
+                                else
                                 {
-                                    gameData->setFeedbackStart(iThisCatId, QDateTime::currentMSecsSinceEpoch());
-                                    gameData->setShowCategoryFeedback(iThisCatId, true);
-                                    gameData->setForceScreenUpdate(true);
+                                    gameData->setPlayerWrongMove(iThisImageId, iThisCatId);
+                                    gameData->setMsgToSend(_PLAYER_MOVE_);
                                 }
+                            }
 
-                                if (gameData->getOneAtATime())
-                                    gameData->setNewOneToShow();
+                            if (gameData->getShowFeedback())
+                            {
+                                gameData->setFeedbackStart(iThisCatId, QDateTime::currentMSecsSinceEpoch());
+                                gameData->setShowCategoryFeedback(iThisCatId, true);
+                                gameData->setForceScreenUpdate(true);
                             }
+
+                            if (gameData->getOneAtATime())
+                                gameData->setNewOneToShow();
                         }
                     }
                 }
@@ -131,15 +131,49 @@ void CheckCategorisation::start()
             }
 
             //mainScene->update();      // if there are any issues with painting, then put this back in, but should be avoided due to inefficiency
+
+            qint64 iPassNs = passTimer.nsecsElapsed();
+            miPasses++;
+            miPassTimeNs += iPassNs;
+            if (iPassNs > miMaxPassNs)
+                miMaxPassNs = iPassNs;
         }
     }
 }
 
+// log wakeups per second and pass timings - an idle board should report 0 wakeups
+void CheckCategorisation::reportStatistics()
+{
+    qint64 iElapsedMs = mStatsClock.restart();
+    float flWakeups = 0, flMeanPassUs = 0;
+
+    if (iElapsedMs > 0)
+        flWakeups = (miPasses * 1000.0) / iElapsedMs;
+
+    if (miPasses > 0)
+        flMeanPassUs = (miPassTimeNs / miPasses) / 1000.0;
+
+    qDebug() << "Collision engine:" << flWakeups << "wakeups/s, mean pass" << flMeanPassUs << "us, max pass" << miMaxPassNs / 1000.0 << "us";
+
+    // estimate only, from sizeof and the image count - the hot arrays a full pass walks, against the ImageDetails list they replaced
+    int iImages = gameData->getNumberOfImages();
+    int iHotBytes = iImages * (sizeof(QPointF) + sizeof(QSize) + (3 * sizeof(bool)));
+    int iStructBytes = iImages * (sizeof(GameData::ImageDetails) + sizeof(void*));
+    qDebug() << "Collision engine:" << iImages << "images, estimated" << iHotBytes << "bytes of image state per pass (" << iStructBytes << "as ImageDetails)";
+
+    miPasses = 0;
+    miPassTimeNs = 0;
+    miMaxPassNs = 0;
+}
+
 void CheckCategorisation::killThread()
 {
     QMutexLocker locker(&mutex);
     {
         mbRun = false;
+
+        if (mStatsTimer)
+            mStatsTimer->stop();
     }
 
     emit finished();    // kills the thread
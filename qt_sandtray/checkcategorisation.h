@@ -24,6 +24,8 @@ signals:
 
 public slots:
     void start();
+    void checkCollisions();
+    void reportStatistics();
     void killThread();
     
 private:
@@ -32,6 +34,12 @@ private:
 
     QMutex mutex;                   // mutex for concurrent access
     bool mbRun;
+
+    QTimer* mStatsTimer;            // only created when performance stats are turned on
+    QElapsedTimer mStatsClock;      // time since the last statistics report
+    int miPasses;                   // collision passes (wakeups) since the last report
+    qint64 miPassTimeNs;            // total time spent in those passes
+    qint64 miMaxPassNs;             // longest single pass since the last report
 };
 
 #endif // CHECKCATEGORISATION_H
@@ -1,28 +1,28 @@
 #include "dragimage.h"
 
-// construct the image data and add it to the gamedata currently used
-DragImage::DragImage(QString sFile, GameData &currData, int idIn)
+// construct the image data and add it to the board being built - its name comes parsed from the library manager
+// the size is the one it was laid out at; the pixels follow with setImage, which may be later for one-at-a-time
+DragImage::DragImage(const LibraryIndex::ImageEntry &image, QSize qsImage, GameData &currData, BoardBuilder &board, int idIn)
 {
     mGameData = &currData;
     myListSlot = idIn;
 
-    QImage qiImage;
-    qiImage.load(sFile);
-    mpxImage = QPixmap::fromImage(qiImage);
-    miImageHeight = mpxImage.height();
-    miImageWidth = mpxImage.width();
+    miImageHeight = qsImage.height();
+    miImageWidth = qsImage.width();
     miLastLadderRung = -1;
     mScaledSize = QSize(0,0);
     mflDistanceMoved = 0;
     mqiStartImageMove = 0;
 
-    QFileInfo fiImage(sFile);
+    mbPerformanceStats = mGameData->getPerformanceStats();
+    miOwnedPaints = 0;
+    miOwnedPaintNs = 0;
 
-    // create image struct and add it to the gamedata list of images
+    // create image struct and add it to the new board's images
     GameData::ImageDetails myDetails;
     myDetails.imageId = myListSlot;
-    myDetails.imageProps = extractImageProps(fiImage);
-    myDetails.catBelonged = fiImage.fileName().mid(0, 1).toUpper(); // first character is the category
+    myDetails.imageProps = image.sProps;
+    myDetails.catBelonged = image.sCategory;
     myDetails.qpfImagePosition = QPointF(1000, 1000);               // default off screen
     myDetails.qsImageSize = QSize(miImageWidth, miImageHeight);
     myDetails.imageOwned = false;
@@ -32,19 +32,54 @@ DragImage::DragImage(QString sFile, GameData &currData, int idIn)
     myDetails.catPlaced = -1;
     myDetails.bGreenBorder = false;
 
-    mGameData->addImageDetails(myDetails);
+    board.addImage(myDetails);
+}
+
+// back to how the constructor leaves the item, for a reset that keeps the library's items - the position is set by the caller
+void DragImage::resetState()
+{
+    if (scene() && scene()->mouseGrabberItem() == this)
+        ungrabMouse();                      // a drag in progress ends with the reset
+
+    miLastLadderRung = -1;
+    mScaledSize = QSize(0,0);
+    mflDistanceMoved = 0;
+    mqiStartImageMove = 0;
+    setScale(1);
+    setZValue(0);
 }
 
-// get the image properties from the filename - use underscore delimiter
-QString DragImage::extractImageProps(QFileInfo fiIm)
+// the decoded pixels - until they arrive nothing is drawn
+void DragImage::setImage(QImage qiImage, QImage qiThumbnail)
 {
-    QRegExp rx("(\\_|\\.)"); //RegEx for '.' or '_'
-    QStringList splitString = fiIm.fileName().split(rx);
+    mpxImage = QPixmap::fromImage(qiImage);
+    if (!qiThumbnail.isNull())
+        mpxThumbnail = QPixmap::fromImage(qiThumbnail);
 
-    splitString.removeAt(0);                        // remove cat/id at start
-    splitString.removeAt(splitString.count() - 1);  // remove file type at end
+    if (!mpxImage.isNull())
+    {
+        mpxOwnedOverlay = QPixmap(mpxImage.size());                             // create pixmap overlay the size of the image
+        mpxOwnedOverlay.fill(Qt::gray);                                         // set the overlay colour
+        mpxOwnedOverlay.setMask(mpxImage.createMaskFromColor(Qt::transparent)); // don't colour parts of the image which are transparent
+    }
 
-    return splitString.join("_");
+    update();
+}
+
+// free the full size pixels of an image seated in a ladder rung - it is drawn from its thumbnail there, so nothing changes on screen
+// kept if there is no thumbnail to draw instead, or the image isn't in a rung and is still drawn at full size
+void DragImage::dropImage()
+{
+    if (mpxThumbnail.isNull() || miLastLadderRung < 0)
+        return;
+
+    mpxImage = QPixmap();
+    mpxOwnedOverlay = QPixmap();
+}
+
+bool DragImage::hasImage()
+{
+    return !mpxImage.isNull();
 }
 
 // get bounding rectange for image - works from top left, so to make image centre of the box
@@ -60,28 +95,43 @@ void DragImage::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     Q_UNUSED(option);
     Q_UNUSED(widget);
 
+    QElapsedTimer paintTimer;
+    if (mbPerformanceStats)
+        paintTimer.start();
+
+    // read everything from this frame's render state - no locking per item
+    const GameData::RenderState &render = mGameData->getRenderState();
+    const GameData::ImageHotState &hot = render.board.imageHot;
+
+    if (myListSlot >= hot.bActive.size())
+        return;                                             // created since the frame started - painted next frame
+
+    bool bActive = hot.bActive.at(myListSlot);
+
     // make sure that the one we are showing is always on top if doing one-at-a-time
-    if (myListSlot == mGameData->getCurrOneToShow())
+    if (myListSlot == render.iCurrOneToShow)
         setZValue(50);
 
     // only paint here if we aren't doing one-at-a-time, or it is active, we are doing one-at-a-time and it is the current one to show, or one-at-a-time, but in ladder
-    if ((mGameData->getImageActive(myListSlot) && myListSlot == mGameData->getCurrOneToShow()) || !mGameData->getImageActive(myListSlot) || !mGameData->getOneAtATime())
+    // in the ladder the item is scaled to the rung, so the thumbnail is already about the size it ends up on screen
+    // an image past the bottom of a full ladder was never seated in a rung, so it is still drawn at full size
+    if (!bActive && miLastLadderRung >= 0 && !mpxThumbnail.isNull())
+        painter->drawPixmap(boundingRect(), mpxThumbnail, QRectF(mpxThumbnail.rect()));
+    else if ((bActive && myListSlot == render.iCurrOneToShow) || !bActive || !render.bOneAtATime)
         painter->drawPixmap(QPointF(miImageWidth * -0.5, miImageHeight * -0.5), mpxImage);
 
-    if (mGameData->getImageOwned(myListSlot))
+    bool bOwned = hot.bOwned.at(myListSlot);
+
+    if (bOwned)
     {
-        QPixmap* pixOverlay = new QPixmap(miImageWidth, miImageHeight);                         // create pixmap overlay the size of the image
-        pixOverlay->fill(Qt::gray);                                                             // set the overlay colour
-        pixOverlay->setMask(mpxImage.createMaskFromColor(Qt::transparent));                     // don't colour parts of the image which are transparent
         painter->setOpacity(0.4);                                                               // apply transparency to our overlay
-        painter->drawPixmap(QPointF(miImageWidth * -0.5, miImageHeight * -0.5), *pixOverlay);   // draw the overlay
-        delete pixOverlay;                                                                      // destroy the item to prevent mem leak
+        painter->drawPixmap(QPointF(miImageWidth * -0.5, miImageHeight * -0.5), mpxOwnedOverlay);
     }
 
     // if the border option is on then see if this image should have one
-    if (mGameData->getTurnTakeMode())
+    if (render.bTurnTakeMode)
     {
-        if (mGameData->getImageGreenBorder(myListSlot))
+        if (render.board.imageCold.at(myListSlot).bGreenBorder)
         {
             // draw a rectangle around the image in green
             QRectF rBound = boundingRect();
@@ -89,19 +139,33 @@ void DragImage::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
             pBorder.setWidth(3);
             pBorder.setBrush(Qt::darkGreen);
             painter->setPen(pBorder);
-            painter->drawRect(QRect(rBound.x(), rBound.y(), rBound.width()-pBorder.width(), rBound.height()-pBorder.width()));
+            // inset by half the pen so the border stays inside the bounds that get redrawn
+            painter->drawRect(QRectF(rBound.x() + (pBorder.width() * 0.5), rBound.y() + (pBorder.width() * 0.5), rBound.width() - pBorder.width(), rBound.height() - pBorder.width()));
         }
     }
 
-    if (!mGameData->getImageActive(myListSlot))
+    if (!bActive)
     {
         setLadderPositionAndScale();                        // inactive so paint in ladder
     }
-    else if (mGameData->getRobotMoving(myListSlot))
+    else if (hot.bRobotMoving.at(myListSlot))
     {
-        if (mGameData->getRobotReadyToMove())
+        if (render.bRobotReadyToMove)
             setRobotMovePosition();                         // robot moving, so update position manually
     }
+
+    // owned paints are the ones that happen while dragging, so those are the ones worth timing
+    if (mbPerformanceStats && bOwned)
+    {
+        miOwnedPaintNs += paintTimer.nsecsElapsed();
+
+        if (++miOwnedPaints == 100)
+        {
+            qDebug() << "Image" << myListSlot << "owned paint:" << (miOwnedPaintNs / miOwnedPaints) / 1000.0 << "us mean over" << miOwnedPaints << "paints," << miImageWidth << "x" << miImageHeight;
+            miOwnedPaints = 0;
+            miOwnedPaintNs = 0;
+        }
+    }
 }
 
 // move the image and update the game structure for the new pos - scale here too (optional var)
@@ -206,9 +270,14 @@ void DragImage::mouseMoveEvent(QGraphicsSceneMouseEvent * event)
 void DragImage::setLadderPositionAndScale()
 {
     // get ladder position for category - need category info, then calc ladder pos relative
-    int iCatPlaced = mGameData->getCatPlaced(myListSlot);
-    int myPosition = getMyPositionInCategory(iCatPlaced);
-    GameData::CategoryDetails myCat = mGameData->getCatDetails()[iCatPlaced];
+    const GameData::RenderState &render = mGameData->getRenderState();
+    int iCatPlaced = render.board.imageCold.at(myListSlot).catPlaced;
+
+    if (iCatPlaced < 0)
+        return;                                             // deactivated, but not yet placed - next frame
+
+    const GameData::CategoryDetails &myCat = render.board.categories.at(iCatPlaced);
+    int myPosition = getMyPositionInCategory(myCat.insideMe);
 
     // update position in ladder
     if (myPosition < myCat.ladderSlots)
@@ -245,10 +314,8 @@ void DragImage::setLadderPositionAndScale()
 }
 
 // loop through the category image list and find the position for this image
-int DragImage::getMyPositionInCategory(int iCatPlaced)
+int DragImage::getMyPositionInCategory(const QList<int> &inCatList)
 {
-    QList<int> inCatList = mGameData->getInsideCategory(iCatPlaced);
-
     for (int iCount = 0; iCount < inCatList.count(); iCount++)
     {
         if (inCatList[iCount] == myListSlot)
@@ -260,9 +327,12 @@ int DragImage::getMyPositionInCategory(int iCatPlaced)
 
 void DragImage::setRobotMovePosition()
 {
-    qint64 iTimeStart = mGameData->getRobotMoveStart();
+    const GameData::RenderState &render = mGameData->getRenderState();
+    const GameData::ImageColdDetails &myDetails = render.board.imageCold.at(myListSlot);
+
+    qint64 iTimeStart = render.iRobotMoveStart;
     qint64 iTimeNow = QDateTime::currentMSecsSinceEpoch();
-    int iTotalTime = mGameData->getRobotMoveTimeMs(myListSlot);
+    int iTotalTime = myDetails.iRobotMoveTime;
     float flPercent = (float(iTimeNow) - float(iTimeStart)) / float(iTotalTime);
 
     if (flPercent >= 1)
@@ -274,12 +344,12 @@ void DragImage::setRobotMovePosition()
         mGameData->setForceScreenUpdate(false);         // assumes robot can only move 1 at a time
     }
 
-    if (!mGameData->getTurnTakeMode())
+    if (!render.bTurnTakeMode)
     {
-        QPointF qpfNewPosition = mGameData->getPointOnRobotMove(myListSlot, flPercent);
+        QPointF qpfNewPosition = myDetails.arcRobotMove.getPointAtFraction(flPercent);   // by distance, so the speed is constant
 
         // bring inside bounds of screen if it goes out - otherwise we lose it!
-        QSize iScreen = mGameData->getScreenSize();
+        QSize iScreen = render.qsScreenSize;
         int iScreenX = iScreen.width() / 2;
         int iScreenY = iScreen.height() / 2;
 
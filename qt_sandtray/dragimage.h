@@ -6,14 +6,20 @@
 #include <qmath.h>
 
 #include "gamedata.h"
+#include "boardbuilder.h"
+#include "libraryindex.h"
 
 class DragImage : public QGraphicsItem
 {
 public:
-    DragImage(QString sFile, GameData &currData, int idIn);
+    DragImage(const LibraryIndex::ImageEntry &image, QSize qsImage, GameData &currData, BoardBuilder &board, int idIn);
 
     QRectF boundingRect() const;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
+    void resetState();
+    void setImage(QImage qiImage, QImage qiThumbnail);
+    void dropImage();
+    bool hasImage();
 
 protected:
     void mousePressEvent(QGraphicsSceneMouseEvent *event);
@@ -21,10 +27,9 @@ protected:
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *event);
 
 private:
-    QString extractImageProps(QFileInfo fiIm);
     void updatePositionOfImage(QPointF qpfPosition, float flScale = -1);
     void setLadderPositionAndScale();
-    int getMyPositionInCategory(int iCatPlaced);
+    int getMyPositionInCategory(const QList<int> &inCatList);
     void setRobotMovePosition();
 
     GameData* mGameData;
@@ -33,11 +38,17 @@ private:
     int miImageHeight;
     int miImageWidth;
     QPixmap mpxImage;
+    QPixmap mpxThumbnail;           // drawn while in a ladder rung, so the scaled down image isn't resampled every paint - null to use mpxImage
+    QPixmap mpxOwnedOverlay;        // grey tint over the opaque parts of the image - built once, drawn while owned
     QPointF qpfPreviousPosition;
     int miLastLadderRung;
     QSize mScaledSize;
     qint64 mqiStartImageMove;
     float mflDistanceMoved;
+
+    bool mbPerformanceStats;        // time owned paints - read once from settings
+    int miOwnedPaints;
+    qint64 miOwnedPaintNs;
 };
 
 #endif
@@ -1,4 +1,8 @@
 #include "gamedata.h"
+#include "boardbuilder.h"
+
+// every accessor takes the one mutex through this, so contention can be recorded per accessor when debug/LockStats is set
+#define LOCK_GAMEDATA InstrumentedLocker locker(&mutex, &lockStats, Q_FUNC_INFO)
 
 GameData::GameData()
 {
@@ -22,6 +26,44 @@ GameData::GameData()
     iMaxLibrary = 0;
     bTurnTakeMode = false;
     bUseSound = true;
+    iCollisionPending = 0;
+    boardLayout.iLibraryId = -1;
+    bLibraryLoading = false;
+    bLibraryFailed = false;
+
+    currentBoard = 0;
+    iBoardEpoch = 1;
+    iBoardVersion = 0;
+    iBoardUpdateDepth = 0;
+    bBoardDirty = false;
+    iBoardPending = 0;
+    publishBoard();                                 // readers always have a board, even before the first library
+
+    renderState.board.iVersion = 0;
+    renderState.iCurrOneToShow = -1;
+    renderState.bOneAtATime = false;
+    renderState.bTurnTakeMode = false;
+    renderState.bShowFeedback = false;
+    renderState.bRobotReadyToMove = false;
+    renderState.iRobotMoveStart = 0;
+
+    if (lockStats.isEnabled())
+        connect(qApp, SIGNAL(aboutToQuit()), this, SLOT(reportLockStats()), Qt::DirectConnection);
+}
+
+// reading threads must have finished - this thread's reader slot is given back here, the others' when their threads exit
+GameData::~GameData()
+{
+    boardReaderSlot.setLocalData(0);
+
+    {
+        LOCK_GAMEDATA;
+
+        while (!retiredBoards.isEmpty())
+            delete retiredBoards.takeFirst().pBoard;
+
+        delete currentBoard.fetchAndStoreOrdered(0);
+    }
 }
 
 // settings - used internally ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -57,345 +99,383 @@ void GameData::retrieveSettingsFromFile(QString sFile)
     bShowFeedback = appSettings.value("game/ShowFeedback").toBool();
     bOneAtATime = appSettings.value("game/OneAtATime").toBool();
     bCentreImages = appSettings.value("game/CentreImages").toBool();
+    bCacheCategories = appSettings.value("game/CacheCategories", true).toBool();
+    iPrefetchMemoryMB = appSettings.value("game/PrefetchMemoryMB", 256).toInt();
+    iImageCacheMB = appSettings.value("game/ImageCacheMB", 512).toInt();
+    bIncrementalReset = appSettings.value("game/IncrementalReset", true).toBool();
+    iDecodeAhead = appSettings.value("game/DecodeAhead", 3).toInt();
+    iImageSpacing = appSettings.value("game/ImageSpacing", -1).toInt();
+
+    // debug   ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    bPerformanceStats = appSettings.value("debug/PerformanceStats").toBool();
+    lockStats.setEnabled(appSettings.value("debug/LockStats").toBool());
 }
 
 QString GameData::getServerIP()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return sServerIP;
 }
 QString GameData::getLibraryPath()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return sLibPath;
 }
 bool GameData::getUseRobot()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bUseRobot;
 }
 int GameData::getLadderWidth()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return iLadderWidth;
 }
 int GameData::getLadderRungs()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return iLadderSlots;
 }
 QString GameData::getRightSound()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return sRightSound;
 }
 QString GameData::getWrongSound()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return sWrongSound;
 }
 QString GameData::getNewLibButton()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return sNewLibButton;
 }
 QString GameData::getResetLibButton()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return sResetLibButton;
 }
 QPixmap GameData::getCorrectFeedback()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return pmCorrectFeedback;
 }
 QPixmap GameData::getIncorrectFeedback()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return pmIncorrectFeedback;
 }
 bool GameData::getShowFeedback()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bShowFeedback;
 }
 void GameData::setShowFeedback(bool bFeedback)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     bShowFeedback = bFeedback;
+    emit sceneChanged();
 }
 bool GameData::getOneAtATime()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bOneAtATime;
 }
 void GameData::setOneAtATime(bool bBoolIn)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     bOneAtATime = bBoolIn;
+    emit sceneChanged();
 }
 bool GameData::getCentreImages()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bCentreImages;
 }
+bool GameData::getCacheCategories()
+{
+    LOCK_GAMEDATA;
+    return bCacheCategories;
+}
+int GameData::getPrefetchMemoryMB()
+{
+    LOCK_GAMEDATA;
+    return iPrefetchMemoryMB;
+}
+int GameData::getImageCacheMB()
+{
+    LOCK_GAMEDATA;
+    return iImageCacheMB;
+}
+bool GameData::getIncrementalReset()
+{
+    LOCK_GAMEDATA;
+    return bIncrementalReset;
+}
+int GameData::getDecodeAhead()
+{
+    LOCK_GAMEDATA;
+    return iDecodeAhead;
+}
+int GameData::getImageSpacing()
+{
+    LOCK_GAMEDATA;
+    return iImageSpacing;
+}
+bool GameData::getPerformanceStats()
+{
+    LOCK_GAMEDATA;
+    return bPerformanceStats;
+}
 
 QSize GameData::getScreenSize()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return iScreenSize;
 }
 void GameData::setScreenSize(QSize iScreenSizeIn)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iScreenSize = iScreenSizeIn;
+
+    // scene origin is the centre of the screen
+    QRect rScreen(-iScreenSize.width() / 2, -iScreenSize.height() / 2, iScreenSize.width(), iScreenSize.height());
+    categoryGrid.setBounds(rScreen);
+    imageGrid.setBounds(rScreen);
 }
 
 bool GameData::getCollisionCheck()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bCollisionCheck;
 }
 void GameData::setCollisionCheck(bool bCheck)
 {
-    QMutexLocker locker(&mutex);
-    bCollisionCheck = bCheck;
+    {
+        LOCK_GAMEDATA;
+        bCollisionCheck = bCheck;
+    }
+
+    if (bCheck)
+        requestCollisionCheck();
+}
+
+// wake the collision thread - only one pass is ever queued, so a burst of moves costs a single check
+void GameData::requestCollisionCheck()
+{
+    if (iCollisionPending.testAndSetOrdered(0, 1))
+        emit boardChanged();
+}
+// called by the collision thread before it reads the board - anything changed after this queues a new pass
+void GameData::clearCollisionRequest()
+{
+    iCollisionPending.fetchAndStoreOrdered(0);
 }
 
 int GameData::getLibraryId()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return iCurrentLibrary;
 }
 void GameData::setLibraryId(int iLibraryId)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iCurrentLibrary = iLibraryId;
 }
 
 // player/game info  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 QString GameData::getLibraryProperties()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return sLibProps;
 }
 void GameData::setLibraryProperties(QString sLibPropsIn)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     sLibProps = sLibPropsIn;
 }
 
 bool GameData::getLibraryTestReserved()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bReserveTestLibs;
 }
 
 int GameData::getLibraryLimit()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return iMaxLibrary;
 }
 void GameData::setLibraryLimit(int iLimit)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iMaxLibrary = iLimit;
 }
 
 bool GameData::getButtonsActive()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bButtonsActive;
 }
 void GameData::setButtonsActive(bool bActive)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     bButtonsActive = bActive;
 }
 
 bool GameData::getShowButtons()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bShowButtons;
 }
 void GameData::setShowButtons(bool bShow)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     bShowButtons = bShow;
 }
 
+// move statistics are streamed - the full lists only hold the most recent moves, see _RECENT_WINDOW_
 QList<float> GameData::getFullTimeList()
 {
-    QMutexLocker locker(&mutex);
-    return flListTimes;
+    LOCK_GAMEDATA;
+    return timeStats.getRecent();
 }
 void GameData::setNewTime(float flTime)
 {
-    QMutexLocker locker(&mutex);
-    flListTimes.prepend(flTime);
+    LOCK_GAMEDATA;
+    timeStats.add(flTime);
+    timeQuantiles.add(flTime);
 }
 float GameData::getAverageTime()
 {
-    QList<float> flTimeListCopy;
-    float flTotalTime = 0;
-    {
-        QMutexLocker locker(&mutex);
-        flTimeListCopy = flListTimes;
-    }
-
-    foreach (float flTime, flTimeListCopy)
-        flTotalTime += flTime;
-
-    if (flTimeListCopy.length() > 0)
-        return flTotalTime / flTimeListCopy.length();
-    else
-        return 0;
+    LOCK_GAMEDATA;
+    return timeStats.getMean();
 }
 float GameData::getLastTime()
 {
-    QMutexLocker locker(&mutex);
-    if (flListTimes.length() > 0)
-        return flListTimes[0];
-    else
-        return -1;
+    LOCK_GAMEDATA;
+    return timeStats.getLast(-1);
+}
+QuantileSketch GameData::getTimeQuantiles()
+{
+    LOCK_GAMEDATA;
+    return timeQuantiles;
 }
 void GameData::clearTimeList()
 {
-    QMutexLocker locker(&mutex);
-    flListTimes.clear();
+    LOCK_GAMEDATA;
+    timeStats.clear();
+    timeQuantiles.clear();
 }
 
 QList<float> GameData::getFullDelayList()
 {
-    QMutexLocker locker(&mutex);
-    return flListDelays;
+    LOCK_GAMEDATA;
+    return delayStats.getRecent();
 }
 void GameData::setNewDelay(float flDelay)
 {
-    QMutexLocker locker(&mutex);
-    flListDelays.prepend(flDelay);
+    LOCK_GAMEDATA;
+    delayStats.add(flDelay);
+    delayQuantiles.add(flDelay);
 }
 float GameData::getAverageDelay()
 {
-    QList<float> flDelayListCopy;
-    float flTotalDelay = 0;
-    {
-        QMutexLocker locker(&mutex);
-        flDelayListCopy = flListDelays;
-    }
-
-    foreach (float flDelay, flDelayListCopy)
-        flTotalDelay += flDelay;
-
-    if (flDelayListCopy.length() > 0)
-        return flTotalDelay / flDelayListCopy.length();
-    else
-        return 0;
+    LOCK_GAMEDATA;
+    return delayStats.getMean();
 }
 float GameData::getLastDelay()
 {
-    QMutexLocker locker(&mutex);
-    if (flListDelays.length() > 0)
-        return flListDelays[0];
-    else
-        return 0;
+    LOCK_GAMEDATA;
+    return delayStats.getLast(0);
+}
+QuantileSketch GameData::getDelayQuantiles()
+{
+    LOCK_GAMEDATA;
+    return delayQuantiles;
 }
 void GameData::clearDelayList()
 {
-    QMutexLocker locker(&mutex);
-    flListDelays.clear();
+    LOCK_GAMEDATA;
+    delayStats.clear();
+    delayQuantiles.clear();
 }
 
 QList<float> GameData::getFullDistanceList()
 {
-    QMutexLocker locker(&mutex);
-    return flListDists;
+    LOCK_GAMEDATA;
+    return distanceStats.getRecent();
 }
 void GameData::setNewDistance(float flDistance)
 {
-    QMutexLocker locker(&mutex);
-    flListDists.prepend(flDistance);
+    LOCK_GAMEDATA;
+    distanceStats.add(flDistance);
+    distanceQuantiles.add(flDistance);
 }
 float GameData::getAverageDistance()
 {
-    QList<float> flDistanceListCopy;
-    float flTotalDistance = 0;
-    {
-        QMutexLocker locker(&mutex);
-        flDistanceListCopy = flListDists;
-    }
-
-    foreach (float flDist, flDistanceListCopy)
-        flTotalDistance += flDist;
-
-    if (flDistanceListCopy.length() > 0)
-        return flTotalDistance / flDistanceListCopy.length();
-    else
-        return 0;
+    LOCK_GAMEDATA;
+    return distanceStats.getMean();
 }
 float GameData::getLastDistance()
 {
-    QMutexLocker locker(&mutex);
-    if (flListDists.length() > 0)
-        return flListDists[0];
-    else
-        return -1;
+    LOCK_GAMEDATA;
+    return distanceStats.getLast(-1);
+}
+QuantileSketch GameData::getDistanceQuantiles()
+{
+    LOCK_GAMEDATA;
+    return distanceQuantiles;
 }
 void GameData::clearDistanceList()
 {
-    QMutexLocker locker(&mutex);
-    flListDists.clear();
+    LOCK_GAMEDATA;
+    distanceStats.clear();
+    distanceQuantiles.clear();
 }
 
 QList<float> GameData::getFullSpeedList()
 {
-    QMutexLocker locker(&mutex);
-    return flListSpeeds;
+    LOCK_GAMEDATA;
+    return speedStats.getRecent();
 }
 void GameData::setNewSpeed(float flSpeed)
 {
-    QMutexLocker locker(&mutex);
-    flListSpeeds.prepend(flSpeed);
+    LOCK_GAMEDATA;
+    speedStats.add(flSpeed);
+    speedQuantiles.add(flSpeed);
 }
 float GameData::getAverageSpeed()
 {
-    QList<float> flSpeedListCopy;
-    float flTotalSpeed = 0;
-    {
-        QMutexLocker locker(&mutex);
-        flSpeedListCopy = flListSpeeds;
-    }
-
-    foreach (float flSpeed, flSpeedListCopy)
-        flTotalSpeed += flSpeed;
-
-    if (flSpeedListCopy.length() > 0)
-        return flTotalSpeed / flSpeedListCopy.length();
-    else
-        return 0;
+    LOCK_GAMEDATA;
+    return speedStats.getMean();
 }
 float GameData::getLastSpeed()
 {
-    QMutexLocker locker(&mutex);
-    if (flListSpeeds.length() > 0)
-        return flListSpeeds[0];
-    else
-        return -1;
+    LOCK_GAMEDATA;
+    return speedStats.getLast(-1);
+}
+QuantileSketch GameData::getSpeedQuantiles()
+{
+    LOCK_GAMEDATA;
+    return speedQuantiles;
 }
 void GameData::clearSpeedList()
 {
-    QMutexLocker locker(&mutex);
-    flListSpeeds.clear();
+    LOCK_GAMEDATA;
+    speedStats.clear();
+    speedQuantiles.clear();
 }
 
 qint64 GameData::getLastMoveEnd()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return iLastMoveEnd;
 }
 void GameData::setLastMoveEnd(qint64 iTime)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iLastMoveEnd = iTime;
 }
 
@@ -403,7 +483,7 @@ int GameData::getNumberPlayerRightMoves()
 {
     QList<int> iCorrectList;
     {
-        QMutexLocker locker(&mutex);            // tie up variable for short time, so make copy
+        LOCK_GAMEDATA;            // tie up variable for short time, so make copy
         iCorrectList = iListCorrectCats;
     }
 
@@ -416,7 +496,7 @@ int GameData::getNumberPlayerRightMoves()
 }
 void GameData::setPlayerRightMove(int iImageId, int iCategoryId)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iListCorrectCats.prepend(1);
     iListCategorised.prepend(iImageId);
     iListInCategory.prepend(iCategoryId);
@@ -425,7 +505,7 @@ int GameData::getNumberPlayerWrongMoves()
 {
     QList<int> iCorrectList;
     {
-        QMutexLocker locker(&mutex);            // tie up variable for short time, so make copy
+        LOCK_GAMEDATA;            // tie up variable for short time, so make copy
         iCorrectList = iListCorrectCats;
     }
 
@@ -438,27 +518,27 @@ int GameData::getNumberPlayerWrongMoves()
 }
 void GameData::setPlayerWrongMove(int iImageId, int iCategoryId)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iListCorrectCats.prepend(0);
     iListCategorised.prepend(iImageId);
     iListInCategory.prepend(iCategoryId);
 }
 void GameData::resetPlayerScore()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iListCorrectCats.clear();
 }
 
 void GameData::setRobotMove(int iImageId, bool bCorrect, int iCategoryId)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     bRobotCorrect.prepend(bCorrect);
     iRobotCategorised.prepend(iImageId);
     iRobotCategory.prepend(iCategoryId);
 }
 int GameData::getLastRobotMoveId()
 {
-   QMutexLocker locker(&mutex);
+   LOCK_GAMEDATA;
    if (iRobotCategorised.length() > 0)
        return iRobotCategorised[0];
    else
@@ -466,7 +546,7 @@ int GameData::getLastRobotMoveId()
 }
 bool GameData::getLastRobotMoveCorrect()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     if (bRobotCorrect.length() > 0)
         return bRobotCorrect[0];
     else
@@ -475,7 +555,7 @@ bool GameData::getLastRobotMoveCorrect()
 
 bool GameData::getLastCategorisationCorrect()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     if (iListCorrectCats.length() > 0)
     {
         if (iListCorrectCats[0] == 1)
@@ -488,7 +568,7 @@ bool GameData::getLastCategorisationCorrect()
 }
 int GameData::getLastImageCategorised()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     if (iListCategorised.length() > 0)
         return iListCategorised[0];
     else
@@ -497,9 +577,9 @@ int GameData::getLastImageCategorised()
 
 QString GameData::getLastPlayerCatProps()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     if (iListInCategory.length() > 0 && categories.length() > 0)
-        return categories[iListInCategory[0]].catProps;
+        return categories.at(iListInCategory[0]).catProps;
     else
         return "";
 }
@@ -514,16 +594,12 @@ void GameData::setMsgToSend(QString sMsg)
 
 bool GameData::getAnyImagesOwned()
 {
-    QList<GameData::ImageDetails> allImages;
-    {
-        QMutexLocker locker(&mutex);
-        allImages = imageLibrary;
-    }
+    BoardReader board(this);
     bool bImagesOwned = false;
 
-    foreach (GameData::ImageDetails thisImage, allImages)
+    for (int iImage = 0; iImage < board->imageHot.bOwned.size(); iImage++)
     {
-        if (thisImage.imageOwned && thisImage.imageActive)
+        if (board->imageHot.bOwned.at(iImage) && board->imageHot.bActive.at(iImage))
         {
             bImagesOwned = true;
             break;
@@ -552,45 +628,46 @@ void GameData::setForceScreenUpdate(bool bUpdate)
 
 int GameData::getRobotSpeed()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return iRobotSpeed;
 }
 void GameData::setRobotSpeed(int iSpeed)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iRobotSpeed = iSpeed;
 }
 
 bool GameData::getRobotReadyToMove()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bRobotReadyToMove;
 }
 void GameData::setRobotReadyToMove(bool bReady)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     bRobotReadyToMove = bReady;
 }
 
 qint64 GameData::getRobotMoveStart()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return iRobotMoveStart;
 }
 void GameData::setRobotMoveStart(qint64 iStartTime)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iRobotMoveStart = iStartTime;
 }
 
 void GameData::setCurrOneToShow(int iImageId)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iCurrOneAtATime = iImageId;
+    emit sceneChanged();
 }
 int GameData::getCurrOneToShow()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
 
     if (iOneToShowShuffled.length() > 0 && iCurrOneAtATime != -1)
         return iOneToShowShuffled[iCurrOneAtATime];
@@ -599,106 +676,117 @@ int GameData::getCurrOneToShow()
 }
 void GameData::setNewOneToShow()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
 
     int iLength = iOneToShowShuffled.length();
     iCurrOneAtATime++;
 
     if (iCurrOneAtATime > iLength - 1)
         iCurrOneAtATime = -1;
+
+    emit sceneChanged();
+    emit oneToShowChanged();        // the library manager decodes the next few ahead
 }
 void GameData::setShuffleOrder()
 {
-    QMutexLocker locker(&mutex);
-    iOneToShowShuffled = getRandomShuffleLibrary(imageLibrary.length());
+    LOCK_GAMEDATA;
+    iOneToShowShuffled = getRandomShuffleLibrary(imageCold.size());
+}
+// an order picked before the library was built, so the images shown first could be decoded first
+void GameData::setShuffleOrder(const QList<int> &iShuffleIn)
+{
+    LOCK_GAMEDATA;
+    iOneToShowShuffled = iShuffleIn;
 }
 
 QString GameData::getCurrOneToShowProps()
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iOneToShowShuffled[iCurrOneAtATime]].imageProps;
+    LOCK_GAMEDATA;
+    return imageCold.at(iOneToShowShuffled[iCurrOneAtATime]).imageProps;
 }
 
 int GameData::getBezierTargetCat()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return iBezierTargetCat;
 }
 void GameData::setBezierTargetCat(int iCategory)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     iBezierTargetCat = iCategory;
 }
 
 bool GameData::getUseSound()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bUseSound;
 }
 void GameData::setUseSound(bool bSound)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     bUseSound = bSound;
 }
 
 // category info ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// lock free - the list comes from the published board, so this is a reference count bump rather than a copy
 QList<GameData::CategoryDetails> GameData::getCatDetails()
 {
-    QMutexLocker locker(&mutex);
-    return categories;
+    BoardReader board(this);
+    return board->categories;
 }
 
-void GameData::addCatDetails(GameData::CategoryDetails catDetails)
-{
-    QMutexLocker locker(&mutex);
-    categories.append(catDetails);
-}
-void GameData::clearCatDetails()
+int GameData::getNumberOfCats()
 {
-    QMutexLocker locker(&mutex);
-    categories.clear();
+    LOCK_GAMEDATA;
+    return categories.length();
 }
 
-int GameData::getNumberOfCats()
+QSize GameData::getCatSizeById(int iCatNo)
 {
-    QMutexLocker locker(&mutex);
-    return categories.length();
+    LOCK_GAMEDATA;
+    return categories.at(iCatNo).qsCatSize;
 }
 
 bool GameData::getCurrOverlap(int iCatNo)
 {
-    QMutexLocker locker(&mutex);
-    return categories[iCatNo].currOverlap;
+    LOCK_GAMEDATA;
+    return categories.at(iCatNo).currOverlap;
 }
 void GameData::setCurrOverlap(int iCatNo, bool bOverlap)
 {
-    QMutexLocker locker(&mutex);
-    categories[iCatNo].currOverlap = bOverlap;
+    LOCK_GAMEDATA;
+    if (categories.at(iCatNo).currOverlap != bOverlap)
+    {
+        categories[iCatNo].currOverlap = bOverlap;
+        markBoardChanged();         // called for every category on every pass, so only mark real changes
+        emit categoryChanged(iCatNo);
+    }
 }
 
 QList<int> GameData::getInsideCategory(int iCatNo)
 {
-    QMutexLocker locker(&mutex);
-    return categories[iCatNo].insideMe;
+    LOCK_GAMEDATA;
+    return categories.at(iCatNo).insideMe;
 }
 void GameData::addInsideCategory(int iCatNo, int iImgId)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     categories[iCatNo].insideMe.prepend(iImgId);
+    markBoardChanged();
+
+    // the newest goes at the top of the ladder, so everything already in it moves down a rung
+    foreach (int iImageId, categories.at(iCatNo).insideMe)
+        emit imageChanged(iImageId);
 }
 
 bool GameData::getAnyCategoryFeedback()
 {
-    QList<GameData::CategoryDetails> allCats;
-    {
-        QMutexLocker locker(&mutex);
-        allCats = categories;
-    }
+    BoardReader board(this);
     bool bFeedback = false;
 
-    foreach (GameData::CategoryDetails thisCat, allCats)
+    for (int iCat = 0; iCat < board->categories.length(); iCat++)
     {
-        if (thisCat.bShowFeedback)
+        if (board->categories.at(iCat).bShowFeedback)
         {
             bFeedback = true;
             break;
@@ -709,24 +797,28 @@ bool GameData::getAnyCategoryFeedback()
 }
 bool GameData::getShowCategoryFeedback(int iCatNo)
 {
-    QMutexLocker locker(&mutex);
-    return categories[iCatNo].bShowFeedback;
+    LOCK_GAMEDATA;
+    return categories.at(iCatNo).bShowFeedback;
 }
 void GameData::setShowCategoryFeedback(int iCatNo, bool bShow)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     categories[iCatNo].bShowFeedback = bShow;
+    markBoardChanged();
+    emit categoryChanged(iCatNo);
 }
 
 bool GameData::getIsFeedbackCorrect(int iCatNo)
 {
-    QMutexLocker locker(&mutex);
-    return categories[iCatNo].bCorrectFeedback;
+    LOCK_GAMEDATA;
+    return categories.at(iCatNo).bCorrectFeedback;
 }
 void GameData::setIsFeedbackCorrect(int iCatNo, bool bCorrect)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     categories[iCatNo].bCorrectFeedback = bCorrect;
+    markBoardChanged();
+    emit categoryChanged(iCatNo);
 }
 
 void GameData::delay()
@@ -738,33 +830,41 @@ void GameData::delay()
 
 qint64 GameData::getFeedbackStart(int iCatNo)
 {
-    QMutexLocker locker(&mutex);
-    return categories[iCatNo].iFeedbackStart;
+    LOCK_GAMEDATA;
+    return categories.at(iCatNo).iFeedbackStart;
 }
 void GameData::setFeedbackStart(int iCatNo, qint64 iStart)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     categories[iCatNo].iFeedbackStart = iStart;
+    markBoardChanged();
+    emit categoryChanged(iCatNo);
 }
 
 void GameData::setCatPos(int iCatId, QPointF qpfMyCentre)
 {
-    QMutexLocker locker(&mutex);
-    categories[iCatId].qpfCatPosition = qpfMyCentre;
+    {
+        LOCK_GAMEDATA;
+        categories[iCatId].qpfCatPosition = qpfMyCentre;
+        categoryGrid.insert(iCatId, SpatialGrid::boundsAround(qpfMyCentre, categories.at(iCatId).qsCatSize));
+        markBoardChanged();
+    }
+
+    requestCollisionCheck();
 }
 
 QString GameData::getCategoryPropertiesById(int iCategoryId)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     if (categories.length() >= iCategoryId)
-        return categories[iCategoryId].catProps;
+        return categories.at(iCategoryId).catProps;
     else
         return "";
 }
 
 QString GameData::getAllCategoryProperties()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     if (categories.length() > 0)
     {
         QStringList sCatProps;
@@ -779,52 +879,117 @@ QString GameData::getAllCategoryProperties()
         return "";
 }
 
+// ids of the images whose bounds currently overlap this category - taken from the spatial grid, not a full scan
+QList<int> GameData::getImagesOverlappingCategory(int iCatNo)
+{
+    LOCK_GAMEDATA;
+    if (iCatNo < 0 || iCatNo >= categories.length())
+        return QList<int>();
+
+    return imageGrid.query(categoryGrid.getItemBounds(iCatNo));
+}
+
 // image set info ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-QList<GameData::ImageDetails> GameData::getImageDetails()
+// copying the arrays only bumps their reference counts, so this is cheap to call every pass
+GameData::ImageHotState GameData::getImageHotState()
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary;
+    BoardReader board(this);
+    return board->imageHot;
 }
-void GameData::addImageDetails(GameData::ImageDetails imDetails)
+
+// put the images and categories back to how a fresh load leaves them, keeping what comes from the files - positions are set after
+void GameData::resetBoardState()
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary.append(imDetails);
+    LOCK_GAMEDATA;
+    imageHot.bOwned.fill(false);
+    imageHot.bActive.fill(true);
+    imageHot.bRobotMoving.fill(false);
+
+    for (int iImage = 0; iImage < imageCold.size(); iImage++)
+    {
+        ImageColdDetails &cold = imageCold[iImage];
+        cold.ppBezier = QPainterPath();
+        cold.qpflBezPoints.clear();
+        cold.arcRobotMove = ArcLengthTable();
+        cold.bRobotLastOwner = false;
+        cold.catPlaced = -1;
+        cold.bGreenBorder = false;
+    }
+
+    for (int iCat = 0; iCat < categories.length(); iCat++)
+    {
+        CategoryDetails &category = categories[iCat];
+        category.insideMe.clear();
+        category.currOverlap = false;
+        category.bShowFeedback = false;
+        category.bCorrectFeedback = false;
+        category.iFeedbackStart = 0;
+    }
+
+    markBoardChanged();
 }
-void GameData::clearImageDetails()
+
+int GameData::getNumberOfImages()
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary.clear();
+    LOCK_GAMEDATA;
+    return imageCold.size();
 }
 
 QPointF GameData::getImagePositionById(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].qpfImagePosition;
+    LOCK_GAMEDATA;
+    return imageHot.qpfPositions.at(iImageId);
 }
 void GameData::setImagePositionById(int iImageId, QPointF qpfPosition)
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary[iImageId].qpfImagePosition = qpfPosition;
+    {
+        LOCK_GAMEDATA;
+        imageHot.qpfPositions[iImageId] = qpfPosition;
+        imageGrid.insert(iImageId, SpatialGrid::boundsAround(qpfPosition, imageHot.qsSizes.at(iImageId)));
+        markBoardChanged();
+    }
+
+    requestCollisionCheck();
+}
+
+// every image placed again at once, e.g. a reset - one publish and one collision pass rather than one per image
+void GameData::setImagePositions(const QVector<QPointF> &qpfPositions)
+{
+    {
+        LOCK_GAMEDATA;
+        for (int iImage = 0; iImage < qpfPositions.size() && iImage < imageHot.qsSizes.size(); iImage++)
+        {
+            imageHot.qpfPositions[iImage] = qpfPositions.at(iImage);
+            imageGrid.insert(iImage, SpatialGrid::boundsAround(qpfPositions.at(iImage), imageHot.qsSizes.at(iImage)));
+        }
+        markBoardChanged();
+    }
+
+    requestCollisionCheck();
 }
 
 QSize GameData::getImageSizeById(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].qsImageSize;
+    LOCK_GAMEDATA;
+    return imageHot.qsSizes.at(iImageId);
 }
 
 bool GameData::getImageOwned(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].imageOwned;
+    LOCK_GAMEDATA;
+    return imageHot.bOwned.at(iImageId);
 }
 void GameData::setImageOwned(int iImageId, bool bOwned)
 {
     {
-        QMutexLocker locker(&mutex);
-        imageLibrary[iImageId].imageOwned = bOwned;
+        LOCK_GAMEDATA;
+        imageHot.bOwned[iImageId] = bOwned;
+        markBoardChanged();
     }
 
+    emit imageChanged(iImageId);
+    requestCollisionCheck();
+
     if (bOwned)
     {
         setMsgToSend(_PLAYER_TOUCH_IMAGE_ + "," + QString::number(iImageId));
@@ -837,136 +1002,140 @@ void GameData::setImageOwned(int iImageId, bool bOwned)
 
 bool GameData::getImageActive(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].imageActive;
+    LOCK_GAMEDATA;
+    return imageHot.bActive.at(iImageId);
 }
 void GameData::setImageActive(int iImageId, bool bActive)
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary[iImageId].imageActive = bActive;
+    {
+        LOCK_GAMEDATA;
+        imageHot.bActive[iImageId] = bActive;
+        markBoardChanged();
+    }
+
+    emit imageChanged(iImageId);
+    requestCollisionCheck();
 }
 
 int GameData::getCatPlaced(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].catPlaced;
+    LOCK_GAMEDATA;
+    return imageCold.at(iImageId).catPlaced;
 }
 void GameData::setCatPlaced(int iImageId, int iCat)
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary[iImageId].catPlaced = iCat;
+    LOCK_GAMEDATA;
+    imageCold[iImageId].catPlaced = iCat;
+    markBoardChanged();
+    emit imageChanged(iImageId);
 }
 
 QString GameData::getCatBelonged(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].catBelonged;
+    LOCK_GAMEDATA;
+    return imageCold.at(iImageId).catBelonged;
 }
 
 QString GameData::getImagePropertiesById(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].imageProps;
+    LOCK_GAMEDATA;
+    return imageCold.at(iImageId).imageProps;
 }
 
 bool GameData::getAnyRobotMoving()
 {
-    QList<GameData::ImageDetails> allImages;
-    {
-        QMutexLocker locker(&mutex);
-        allImages = imageLibrary;
-    }
-    bool bImagesOwned = false;
-
-    foreach (GameData::ImageDetails thisImage, allImages)
-    {
-        if (thisImage.bRobotMoving)
-        {
-            bImagesOwned = true;
-            break;
-        }
-    }
-
-    return bImagesOwned;
+    BoardReader board(this);
+    return board->imageHot.bRobotMoving.contains(true);
 }
 
 // robot move info ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool GameData::getRobotMoving(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].bRobotMoving;
+    LOCK_GAMEDATA;
+    return imageHot.bRobotMoving.at(iImageId);
 }
 void GameData::setRobotMoving(int iImageId, bool bRobotMoving)
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary[iImageId].bRobotMoving = bRobotMoving;
+    LOCK_GAMEDATA;
+    imageHot.bRobotMoving[iImageId] = bRobotMoving;
+    markBoardChanged();
+    emit imageChanged(iImageId);
 }
 
 int GameData::getRobotMoveTimeMs(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].iRobotMoveTime;
+    LOCK_GAMEDATA;
+    return imageCold.at(iImageId).iRobotMoveTime;
 }
 void GameData::setRobotMoveTimeMs(int iImageId, int iTimeLength)
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary[iImageId].iRobotMoveTime = iTimeLength;
+    LOCK_GAMEDATA;
+    imageCold[iImageId].iRobotMoveTime = iTimeLength;
+    markBoardChanged();
 }
 
 QPainterPath GameData::getRobotMovePath(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].ppBezier;
+    LOCK_GAMEDATA;
+    return imageCold.at(iImageId).ppBezier;
 }
 void GameData::setRobotMovePath(int iImageId, QPainterPath ppBezierIn)
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary[iImageId].ppBezier = ppBezierIn;
+    LOCK_GAMEDATA;
+    imageCold[iImageId].ppBezier = ppBezierIn;
+    markBoardChanged();
 }
 
-QPointF GameData::getPointOnRobotMove(int iImageId, float flTParamater)
+ArcLengthTable GameData::getRobotMoveTable(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-
-    if (imageLibrary[iImageId].bRobotMoving)
-        return imageLibrary[iImageId].ppBezier.pointAtPercent(flTParamater);
-    else
-        return imageLibrary[iImageId].qpfImagePosition;
+    LOCK_GAMEDATA;
+    return imageCold.at(iImageId).arcRobotMove;
+}
+void GameData::setRobotMoveTable(int iImageId, ArcLengthTable arcTable)
+{
+    LOCK_GAMEDATA;
+    imageCold[iImageId].arcRobotMove = arcTable;
+    markBoardChanged();
 }
 
 void GameData::setRobotOwned(int iImageId, bool bOwned)
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary[iImageId].bRobotLastOwner = bOwned;
+    LOCK_GAMEDATA;
+    imageCold[iImageId].bRobotLastOwner = bOwned;
+    markBoardChanged();
 }
 bool GameData::getRobotOwned(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].bRobotLastOwner;
+    LOCK_GAMEDATA;
+    return imageCold.at(iImageId).bRobotLastOwner;
 }
 
 void GameData::setRobotLocked(bool bLock)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     bCollisionCheck = false;
     bRobotLocked = bLock;
     bCollisionCheck = true;
+    locker.unlock();
+
+    requestCollisionCheck();
 }
 bool GameData::getRobotLocked()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bRobotLocked;
 }
 
 QList<QPointF> GameData::getMovePoints(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].qpflBezPoints;
+    LOCK_GAMEDATA;
+    return imageCold.at(iImageId).qpflBezPoints;
 }
 void GameData::setMovePoints(int iImageId, QList<QPointF> qpflBezier)
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary[iImageId].qpflBezPoints = qpflBezier;
+    LOCK_GAMEDATA;
+    imageCold[iImageId].qpflBezPoints = qpflBezier;
+    markBoardChanged();
 }
 
 QList<int> GameData::getRandomShuffleLibrary(int iImagesInLib)
@@ -1001,24 +1170,296 @@ int GameData::getRandomNumber(int min, int max)
 
 void GameData::setTurnTakeMode(bool bTurnTake)
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     bTurnTakeMode = bTurnTake;
+    emit sceneChanged();
 }
 
 bool GameData::getTurnTakeMode()
 {
-    QMutexLocker locker(&mutex);
+    LOCK_GAMEDATA;
     return bTurnTakeMode;
 }
 
+// board layout ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+GameData::BoardLayout GameData::getBoardLayout()
+{
+    LOCK_GAMEDATA;
+    return boardLayout;
+}
+// a new layout means a library is on its way in - cleared again once its items are built
+void GameData::setBoardLayout(GameData::BoardLayout layout)
+{
+    LOCK_GAMEDATA;
+    boardLayout = layout;
+    bLibraryLoading = true;
+}
+
+bool GameData::getLibraryLoading()
+{
+    LOCK_GAMEDATA;
+    return bLibraryLoading;
+}
+void GameData::setLibraryLoading(bool bLoading)
+{
+    LOCK_GAMEDATA;
+    bLibraryLoading = bLoading;
+}
+
+bool GameData::getLibraryFailed()
+{
+    LOCK_GAMEDATA;
+    return bLibraryFailed;
+}
+void GameData::setLibraryFailed(bool bFailed)
+{
+    LOCK_GAMEDATA;
+    bLibraryFailed = bFailed;
+}
+
 void GameData::setImageGreenBorder(int iImageId, bool bBorder)
 {
-    QMutexLocker locker(&mutex);
-    imageLibrary[iImageId].bGreenBorder = bBorder;
+    LOCK_GAMEDATA;
+    imageCold[iImageId].bGreenBorder = bBorder;
+    markBoardChanged();
+    emit imageChanged(iImageId);
 }
 
 bool GameData::getImageGreenBorder(int iImageId)
 {
-    QMutexLocker locker(&mutex);
-    return imageLibrary[iImageId].bGreenBorder;
+    LOCK_GAMEDATA;
+    return imageCold.at(iImageId).bGreenBorder;
+}
+
+// lock statistics ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool GameData::getLockStatsEnabled()
+{
+    return lockStats.isEnabled();       // fixed at start up, so no need to lock
+}
+
+// top sites by wait time, for the server
+QString GameData::getLockStatsSummary(int iMaxSites)
+{
+    return lockStats.getSummary(iMaxSites);
+}
+
+// full table to the debug output - on exit and on request from the server
+void GameData::reportLockStats()
+{
+    foreach (QString sLine, lockStats.getReport())
+        qDebug() << sLine.toStdString().c_str();
+}
+
+// render state ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// one board read and one lock per frame, however many items paint
+void GameData::captureRenderState()
+{
+    {
+        BoardReader board(this);
+
+        if (board->iVersion != renderState.board.iVersion)
+            renderState.board = *board;    // implicitly shared, so only reference counts are copied
+    }
+
+    LOCK_GAMEDATA;
+
+    if (iOneToShowShuffled.length() > 0 && iCurrOneAtATime != -1)
+        renderState.iCurrOneToShow = iOneToShowShuffled.at(iCurrOneAtATime);
+    else
+        renderState.iCurrOneToShow = -1;
+
+    renderState.bOneAtATime = bOneAtATime;
+    renderState.bTurnTakeMode = bTurnTakeMode;
+    renderState.bShowFeedback = bShowFeedback;
+    renderState.bRobotReadyToMove = bRobotReadyToMove;
+    renderState.iRobotMoveStart = iRobotMoveStart;
+    renderState.qsScreenSize = iScreenSize;
+}
+
+// no lock - only valid on the GUI thread, between captures
+const GameData::RenderState &GameData::getRenderState() const
+{
+    return renderState;
+}
+
+// board snapshot ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// hold back publishing so readers never see a half-built board, e.g. while a library is being swapped
+void GameData::beginBoardUpdate()
+{
+    LOCK_GAMEDATA;
+
+    if (iBoardUpdateDepth == 0 && bBoardDirty)
+        publishBoard();             // changes from before the batch aren't held back with it
+
+    iBoardUpdateDepth++;
+}
+void GameData::endBoardUpdate()
+{
+    LOCK_GAMEDATA;
+    iBoardUpdateDepth--;
+
+    if (iBoardUpdateDepth == 0 && bBoardDirty)
+        publishBoard();
+}
+
+// take over a whole library's tables in one go - the builder did the work, so the lock is only held for a few assignments
+void GameData::setBoard(const BoardBuilder &board)
+{
+    {
+        LOCK_GAMEDATA;
+        categories = board.getCategories();
+        imageHot = board.getImageHot();
+        imageCold = board.getImageCold();
+        categoryGrid = board.getCategoryGrid();
+        imageGrid = board.getImageGrid();
+        publishBoard();
+    }
+
+    requestCollisionCheck();
+}
+
+// a writer changed the tables - the next reader publishes them, so the changes between two reads (drag moves within a frame, a collision pass) cost one snapshot
+// must be called with the mutex held
+void GameData::markBoardChanged()
+{
+    bBoardDirty = true;
+
+    if (iBoardUpdateDepth == 0)
+        iBoardPending.fetchAndStoreRelease(1);
+}
+
+// swap in a new board for readers - must be called with the mutex held, so there is only ever one writer
+void GameData::publishBoard()
+{
+    if (iBoardUpdateDepth > 0)
+    {
+        bBoardDirty = true;
+        return;
+    }
+
+    // the lists are implicitly shared, so the new board costs a few reference counts - the next write detaches
+    BoardSnapshot* pNewBoard = new BoardSnapshot;
+    pNewBoard->iVersion = ++iBoardVersion;
+    pNewBoard->categories = categories;
+    pNewBoard->imageHot = imageHot;
+    pNewBoard->imageCold = imageCold;
+    bBoardDirty = false;
+    iBoardPending.fetchAndStoreRelease(0);
+
+    BoardSnapshot* pOldBoard = currentBoard.fetchAndStoreOrdered(pNewBoard);
+
+    if (pOldBoard)
+    {
+        RetiredBoard retired;
+        retired.pBoard = pOldBoard;
+        retired.iEpoch = iBoardEpoch;
+        retiredBoards.append(retired);
+    }
+
+    // readers entering after this can only see the new board
+    if (iBoardEpoch.fetchAndAddOrdered(1) == -1)
+        iBoardEpoch.fetchAndAddOrdered(1);      // skip 0 on wrap around - it marks an idle slot
+
+    reclaimRetiredBoards();
+}
+
+// delete retired boards that no reader can still be looking at - called with the mutex held
+void GameData::reclaimRetiredBoards()
+{
+    while (!retiredBoards.isEmpty())
+    {
+        int iRetiredEpoch = retiredBoards.first().iEpoch;
+
+        // a reader that entered at or before the epoch the board was retired in may still be using it
+        for (int iSlot = 0; iSlot < _MAX_BOARD_READERS_; iSlot++)
+        {
+            int iReaderEpoch = iReaderEpochs[iSlot];
+
+            if (iReaderEpoch != 0 && (iReaderEpoch - iRetiredEpoch) <= 0)
+                return;
+        }
+
+        delete retiredBoards.takeFirst().pBoard;
+    }
+}
+
+// mark this thread as reading and hand back the current board - no lock unless every reader slot is taken or there are changes to publish
+const GameData::BoardSnapshot* GameData::enterBoardRead()
+{
+    BoardReaderSlot* pSlot = boardReaderSlot.localData();
+
+    // publish before this thread counts as reading, so reclaiming doesn't wait on it - nested reads keep the board they started with
+    if ((!pSlot || pSlot->iDepth == 0) && iBoardPending != 0)      // checked again under the lock
+    {
+        LOCK_GAMEDATA;
+
+        if (bBoardDirty && iBoardUpdateDepth == 0)
+            publishBoard();
+    }
+
+    if (!pSlot)
+    {
+        pSlot = new BoardReaderSlot;
+        pSlot->pData = this;
+        pSlot->iIndex = -1;
+        pSlot->iDepth = 0;
+        pSlot->pLocker = 0;
+
+        for (int iSlot = 0; iSlot < _MAX_BOARD_READERS_; iSlot++)
+        {
+            if (iReaderSlotClaimed[iSlot].testAndSetOrdered(0, 1))
+            {
+                pSlot->iIndex = iSlot;
+                break;
+            }
+        }
+
+        boardReaderSlot.setLocalData(pSlot);
+    }
+
+    if (pSlot->iDepth++ == 0)
+    {
+        if (pSlot->iIndex < 0)
+            pSlot->pLocker = new InstrumentedLocker(&mutex, &lockStats, Q_FUNC_INFO);   // no slot free - keep writers (and so reclamation) out for the read instead
+        else
+            iReaderEpochs[pSlot->iIndex].fetchAndStoreOrdered(iBoardEpoch);
+    }
+
+    return currentBoard;
+}
+
+void GameData::leaveBoardRead()
+{
+    BoardReaderSlot* pSlot = boardReaderSlot.localData();
+
+    if (--pSlot->iDepth == 0)
+    {
+        if (pSlot->iIndex < 0)
+        {
+            delete pSlot->pLocker;
+            pSlot->pLocker = 0;
+        }
+        else
+            iReaderEpochs[pSlot->iIndex].fetchAndStoreRelease(0);
+    }
+}
+
+// thread finished - give its slot back for the next reading thread
+GameData::BoardReaderSlot::~BoardReaderSlot()
+{
+    if (iIndex >= 0)
+    {
+        pData->iReaderEpochs[iIndex].fetchAndStoreRelease(0);
+        pData->iReaderSlotClaimed[iIndex].fetchAndStoreRelease(0);
+    }
+}
+
+GameData::BoardReader::BoardReader(GameData* pData)
+{
+    mpData = pData;
+    mpBoard = mpData->enterBoardRead();
+}
+GameData::BoardReader::~BoardReader()
+{
+    mpData->leaveBoardRead();
 }
@@ -5,6 +5,15 @@
 #include <QtGui>
 
 #include "messages.h"
+#include "spatialgrid.h"
+#include "lockstats.h"
+#include "runningstats.h"
+#include "quantilesketch.h"
+#include "arclengthtable.h"
+
+const int _MAX_BOARD_READERS_ = 32;                 // threads that can read the board snapshot without the mutex
+
+class BoardBuilder;
 
 class GameData : public QObject
 {
@@ -12,6 +21,7 @@ class GameData : public QObject
 
 public:
     explicit GameData();
+   ~GameData();
 
     // general library/player info ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     void retrieveSettingsFromFile(QString sFile);
@@ -31,12 +41,20 @@ public:
     bool getOneAtATime();
     void setOneAtATime(bool bBoolIn);
     bool getCentreImages();
+    bool getCacheCategories();
+    int getPrefetchMemoryMB();
+    int getImageCacheMB();
+    bool getIncrementalReset();
+    int getDecodeAhead();
+    int getImageSpacing();
+    bool getPerformanceStats();
 
     QSize getScreenSize();
     void setScreenSize(QSize iScreenSizeIn);
 
     bool getCollisionCheck();
     void setCollisionCheck(bool bCheck);
+    void clearCollisionRequest();
 
     int getLibraryId();
     void setLibraryId(int iLibraryId);
@@ -59,24 +77,28 @@ public:
     void setNewTime(float flTime);
     float getAverageTime();
     float getLastTime();
+    QuantileSketch getTimeQuantiles();
     void clearTimeList();
 
     QList<float> getFullDelayList();
     void setNewDelay(float flDelay);
     float getAverageDelay();
     float getLastDelay();
+    QuantileSketch getDelayQuantiles();
     void clearDelayList();
 
     QList<float> getFullDistanceList();
     void setNewDistance(float flDistance);
     float getAverageDistance();
     float getLastDistance();
+    QuantileSketch getDistanceQuantiles();
     void clearDistanceList();
 
     QList<float> getFullSpeedList();
     void setNewSpeed(float flSpeed);
     float getAverageSpeed();
     float getLastSpeed();
+    QuantileSketch getSpeedQuantiles();
     void clearSpeedList();
 
     qint64 getLastMoveEnd();
@@ -119,6 +141,7 @@ public:
     int getCurrOneToShow();
     void setNewOneToShow();
     void setShuffleOrder();
+    void setShuffleOrder(const QList<int> &iShuffleIn);
 
     QString getCurrOneToShowProps();
 
@@ -149,10 +172,9 @@ public:
     };
 
     QList<CategoryDetails> getCatDetails();
-    void addCatDetails(CategoryDetails catDetails);
-    void clearCatDetails();
 
     int getNumberOfCats();
+    QSize getCatSizeById(int iCatNo);
 
     bool getCurrOverlap(int iCatNo);
     void setCurrOverlap(int iCatNo, bool bOverlap);
@@ -175,6 +197,8 @@ public:
     QString getCategoryPropertiesById(int iCategoryId);
     QString getAllCategoryProperties();
 
+    QList<int> getImagesOverlappingCategory(int iCatNo);
+
     // image set info ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     struct ImageDetails
     {
@@ -194,12 +218,39 @@ public:
         bool bGreenBorder;              // whether the img has green border
     };
 
-    QList<ImageDetails> getImageDetails();
-    void addImageDetails(ImageDetails imDetails);
-    void clearImageDetails();
+    // the fields touched by every collision pass and repaint, held as parallel arrays indexed by image id
+    struct ImageHotState
+    {
+        QVector<QPointF> qpfPositions;  // position of each image (x,y)
+        QVector<QSize> qsSizes;         // image size in pixels
+        QVector<bool> bOwned;           // owned by user or not
+        QVector<bool> bActive;          // whether the img is categorised or not
+        QVector<bool> bRobotMoving;     // whether the robot is in the process of moving the image
+    };
+
+    // the rest of an image's details - only read when an image is categorised, moved by the robot or reported
+    struct ImageColdDetails
+    {
+        int imageId;
+        QString imageProps;
+        QString catBelonged;
+        QPainterPath ppBezier;
+        QList<QPointF> qpflBezPoints;
+        ArcLengthTable arcRobotMove;    // the same bezier by distance - positions the image during the move
+        bool bRobotLastOwner;
+        int iRobotMoveTime;
+        int catPlaced;
+        bool bGreenBorder;
+    };
+
+    ImageHotState getImageHotState();
+    void resetBoardState();
+
+    int getNumberOfImages();
 
     QPointF getImagePositionById(int iImageId);
     void setImagePositionById(int iImageId, QPointF qpfPosition);
+    void setImagePositions(const QVector<QPointF> &qpfPositions);
 
     QSize getImageSizeById(int iImageId);
 
@@ -225,8 +276,8 @@ public:
 
     QPainterPath getRobotMovePath(int iImageId);
     void setRobotMovePath(int iImageId, QPainterPath ppBezierIn);
-
-    QPointF getPointOnRobotMove(int iImageId, float flTParamater);
+    ArcLengthTable getRobotMoveTable(int iImageId);
+    void setRobotMoveTable(int iImageId, ArcLengthTable arcTable);
 
     void setRobotOwned(int iImageId, bool bOwned);
     bool getRobotOwned(int iImageId);
@@ -246,8 +297,73 @@ public:
     void setTurnTakeMode(bool bTurnTake);
     bool getTurnTakeMode();
 
+    // board layout ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // where a library being loaded will put everything - worked out from the image headers before any pixels are decoded
+    struct BoardLayout
+    {
+        int iLibraryId;
+        QString sLibraryProps;
+        QStringList slCategoryProps;
+        QList<QPointF> qpfCategoryPositions;
+        QList<QSize> qsCategorySizes;
+        QList<QPointF> qpfImagePositions;
+        QList<QSize> qsImageSizes;
+    };
+
+    BoardLayout getBoardLayout();
+    void setBoardLayout(BoardLayout layout);
+
+    bool getLibraryLoading();
+    void setLibraryLoading(bool bLoading);
+    bool getLibraryFailed();
+    void setLibraryFailed(bool bFailed);
+
+    // board snapshot ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // immutable copy of the categories and images, republished by the first read after a change; readers rarely take the mutex
+    struct BoardSnapshot
+    {
+        int iVersion;                           // increases by one with every publish
+        QList<CategoryDetails> categories;
+        ImageHotState imageHot;
+        QVector<ImageColdDetails> imageCold;
+    };
+
+    void beginBoardUpdate();
+    void endBoardUpdate();
+    void setBoard(const BoardBuilder &board);
+
+    // render state ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // everything the items read while painting, captured once per frame by the view - GUI thread only
+    struct RenderState
+    {
+        BoardSnapshot board;
+        int iCurrOneToShow;
+        bool bOneAtATime;
+        bool bTurnTakeMode;
+        bool bShowFeedback;
+        bool bRobotReadyToMove;
+        qint64 iRobotMoveStart;
+        QSize qsScreenSize;
+    };
+
+    void captureRenderState();
+    const RenderState &getRenderState() const;
+
+    // lock statistics ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    bool getLockStatsEnabled();
+    QString getLockStatsSummary(int iMaxSites);
+
+public slots:
+    void reportLockStats();
+
 signals:
     void readyWrite(QString sMessage);
+    void boardChanged();
+    // what needs redrawing - always connected queued, as they are emitted with the mutex held
+    void imageChanged(int iImageId);
+    void categoryChanged(int iCatNo);
+    void sceneChanged();
+    void oneToShowChanged();
     void newGame();
     void resetGame();
     void forceUpdateScreen();
@@ -255,8 +371,49 @@ signals:
 
 private:
     QPainterPath calculateBezierPath(int iImageId);
+    void requestCollisionCheck();
+
+    // epoch based reclamation for the board snapshot - a retired board is deleted once no reader can still hold it
+    struct RetiredBoard
+    {
+        BoardSnapshot* pBoard;
+        int iEpoch;                     // board epoch at the time it was replaced
+    };
+
+    // each reading thread claims one epoch slot the first time it reads; released again when the thread ends
+    struct BoardReaderSlot
+    {
+        GameData* pData;
+        int iIndex;                     // slot claimed in iReaderEpochs, -1 if all were taken
+        int iDepth;                     // nested reads on this thread
+        InstrumentedLocker* pLocker;    // holds the mutex for a read when no slot was free
+        ~BoardReaderSlot();
+    };
+
+    // holds the current board for the lifetime of the reader
+    class BoardReader
+    {
+    public:
+        BoardReader(GameData* pData);
+        ~BoardReader();
+        const BoardSnapshot* operator->() const { return mpBoard; }
+        const BoardSnapshot& operator*() const { return *mpBoard; }
+
+    private:
+        GameData* mpData;
+        const BoardSnapshot* mpBoard;
+    };
+    friend class BoardReader;
+    friend struct BoardReaderSlot;
+
+    void markBoardChanged();
+    void publishBoard();
+    void reclaimRetiredBoards();
+    const BoardSnapshot* enterBoardRead();
+    void leaveBoardRead();
 
     QMutex mutex;                   // mutex for concurrent access
+    LockStats lockStats;            // wait/hold times on the mutex - only recorded if debug/LockStats is set
 
     // general library/player info
     QString sLibPath;               // root library directory - set in settings.txt
@@ -274,16 +431,22 @@ private:
     QList<int> iListCategorised;    // list of id's of categorised images - insert to front, so first is newest
     QList<int> iListCorrectCats;    // 0 = wrong, 1 = correct - insert to front - can tie in with above
     QList<int> iListInCategory;     // category the image was put in - to return properties to urbi; same order as above
-    QList<float> flListTimes;       // list of move times
-    QList<float> flListDelays;      // list of move delays
-    QList<float> flListDists;       // list of move distances
-    QList<float> flListSpeeds;      // list of move speeds (pixels per second)
+    RunningStats timeStats;         // move times
+    RunningStats delayStats;        // move delays
+    RunningStats distanceStats;     // move distances
+    RunningStats speedStats;        // move speeds (pixels per second)
+    QuantileSketch timeQuantiles;       // distributions of the above - for medians and tails
+    QuantileSketch delayQuantiles;
+    QuantileSketch distanceQuantiles;
+    QuantileSketch speedQuantiles;
     QList<int> iRobotCategorised;   // list of robot categorised images
     QList<bool> bRobotCorrect;      // true for correct, false incorrect; same order as above
     QList<int> iRobotCategory;      // category the robot put image in; same order as above
     QList<int> iOneToShowShuffled;  // shuffled order for the showing one at a time
     bool bUseRobot;                 // flag for standalone, or with robot game engine
     bool bCollisionCheck;           // flag to turn on/off collision checking
+    QAtomicInt iCollisionPending;   // 1 while a collision pass is queued - stops a drag flooding the collision thread
+    bool bPerformanceStats;         // log timing/counter statistics to the debug output - set in settings.ini
     bool bRobotReadyToMove;         // flag to start moving images by robot
     int iRobotSpeed;                // speed the robot moves at - used for bezier calcs
     qint64 iRobotMoveStart;         // start in msecs at start of move (use QDateTime::currMSecsSinceEpoch)
@@ -301,11 +464,36 @@ private:
     int iCurrOneAtATime;            // variable storing the current image to show if we are doing it one at a time
     int iBezierTargetCat;           // target category for the robot move
     bool bCentreImages;             // centre images when showing one-at-a-time
+    bool bCacheCategories;          // draw categories from pre-rendered pixmaps - on unless turned off in settings, for A/B tests
+    int iPrefetchMemoryMB;          // largest decoded size of the next library that will be prefetched - 0 turns prefetching off
+    int iImageCacheMB;              // budget for decoded images kept between library loads
+    bool bIncrementalReset;         // reset the library on screen in place - on unless turned off in settings, to time the full rebuild
+    int iImageSpacing;              // gap kept between placed images in pixels - negative lets images overlap each other, as they always could
+    int iDecodeAhead;               // one-at-a-time decodes the image shown and this many after it in the shuffle - negative decodes the whole library
     bool bTurnTakeMode;             // switch program operation based on game mode
+    BoardLayout boardLayout;        // layout of the library loaded last - ahead of the board while it decodes
+    bool bLibraryLoading;           // a library is laid out but its items aren't in the scene yet
+    bool bLibraryFailed;            // the library asked for last couldn't be found - the one before stays on screen
     bool bUseSound;                 // switch sound on/off
 
     QList<CategoryDetails> categories;      // category info
-    QList<ImageDetails> imageLibrary;       // image set info
+    ImageHotState imageHot;                 // image set info - hot fields, contiguous per field
+    QVector<ImageColdDetails> imageCold;    // image set info - everything else, same index as above
+    SpatialGrid categoryGrid;               // category bounds - kept in step with categories for overlap tests
+    SpatialGrid imageGrid;                  // image bounds - updated on every position change
+
+    QAtomicPointer<BoardSnapshot> currentBoard;         // the board readers see - swapped whole by publishBoard()
+    QList<RetiredBoard> retiredBoards;                  // replaced boards waiting for their readers to finish
+    QAtomicInt iBoardEpoch;                             // bumped after every swap; never 0, which marks an idle reader slot
+    QAtomicInt iReaderEpochs[_MAX_BOARD_READERS_];      // epoch each reading thread entered at, 0 when not reading
+    QAtomicInt iReaderSlotClaimed[_MAX_BOARD_READERS_]; // 1 while a thread owns the slot
+    QThreadStorage<BoardReaderSlot*> boardReaderSlot;   // this thread's slot
+    int iBoardVersion;                                  // version of the last published board
+    int iBoardUpdateDepth;                              // > 0 while a batch of changes is held back from readers
+    bool bBoardDirty;                                   // the tables have changed since the last publish
+    QAtomicInt iBoardPending;                           // 1 when the next reader should publish - not set inside a batch
+
+    RenderState renderState;                            // this frame's view of the game - only touched by the GUI thread
     void delay();
 };
 
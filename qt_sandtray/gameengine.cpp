@@ -3,6 +3,7 @@
 GameEngine::GameEngine(QGraphicsScene &sceneIn)
 {
     mainScene = &sceneIn;
+    mainData = 0;
 }
 
 GameEngine::~GameEngine()
@@ -14,12 +15,17 @@ GameEngine::~GameEngine()
     //collisionThread->quit();
     //collisionThread->wait();
     //delete collisionThread;
-    //delete refreshThread;
+}
+
+GameData* GameEngine::getGameData()
+{
+    return mainData;
 }
 
 void GameEngine::createScene()
 {
-    GameData *mainData = new GameData();
+    QThread::currentThread()->setObjectName("gui");        // thread names label the lock statistics
+    mainData = new GameData();
     mainData->setScreenSize(QSize(mainScene->width(), mainScene->height()));    // use this quite often throughout - done here to be thread safe
 
     // the library manager creates instances of the images and categories and adds them to the scene
@@ -28,6 +34,7 @@ void GameEngine::createScene()
 
     // check for overlaps between images and categories when no user input - game logic thread
     collisionThread = new QThread;
+    collisionThread->setObjectName("collision");
     collision = new CheckCategorisation(*mainScene, *mainData);
     collision->moveToThread(collisionThread);
     connect(collision, SIGNAL(error(QString)), this, SLOT(errorString(QString)));
@@ -37,12 +44,15 @@ void GameEngine::createScene()
     connect(collisionThread, SIGNAL(finished()), collisionThread, SLOT(deleteLater()));
     connect(collision, SIGNAL(playSound(QString)), this, SLOT(playSound(QString)));
     connect(this, SIGNAL(appClosing()), collision, SLOT(killThread()));
+    // always queued - the collision pass itself changes the board, and must not recurse into another pass
+    connect(mainData, SIGNAL(boardChanged()), collision, SLOT(checkCollisions()), Qt::QueuedConnection);
     collisionThread->start();
 
     if (mainData->getUseRobot())
     {
         // launch urbi send thread, give it access to *mainData
         QThread* urbiSendThread = new QThread;
+        urbiSendThread->setObjectName("urbi send");
         UrbiSend* urbiSend = new UrbiSend(*mainData);
         urbiSend->moveToThread(urbiSendThread);
         connect(urbiSend, SIGNAL(error(QString)), this, SLOT(errorString(QString)));
@@ -54,6 +64,7 @@ void GameEngine::createScene()
 
         // launch urbi receive thread, give it access to *mainData
         QThread* urbiRecThread = new QThread;
+        urbiRecThread->setObjectName("urbi receive");
         UrbiReceive* urbiRec = new UrbiReceive(*mainData, *clsLibManager);
         urbiRec->moveToThread(urbiRecThread);
         connect(urbiRec, SIGNAL(error(QString)), this, SLOT(errorString(QString)));
@@ -65,18 +76,15 @@ void GameEngine::createScene()
     }
 
     // connect to the GameData class to join the forced screen update routines
-    refreshThread = new QThread;
+    // stays on the GUI thread - a timer there paces the redraws, rather than a worker thread flooding it with updates
+    // queued, as the start/stop requests can come from inside paint
     refresh = new RefreshScreen(*mainScene, *mainData);
-    refresh->moveToThread(refreshThread);
     connect(refresh, SIGNAL(error(QString)), this, SLOT(errorString(QString)));
-    connect(refreshThread, SIGNAL(started()), refresh, SLOT(start()));
-    connect(refresh, SIGNAL(finished()), refreshThread, SLOT(quit()));
-    //connect(refresh, SIGNAL(finished()), refresh, SLOT(deleteLater()));
-    connect(refreshThread, SIGNAL(finished()), this, SLOT(deleteLater()));
-    connect(mainData, SIGNAL(forceUpdateScreen()), refresh, SLOT(startUpdate()));
-    connect(mainData, SIGNAL(stopUpdateScreen()), refresh, SLOT(stopUpdate()));
+    connect(mainData, SIGNAL(forceUpdateScreen()), refresh, SLOT(startUpdate()), Qt::QueuedConnection);
+    connect(mainData, SIGNAL(stopUpdateScreen()), refresh, SLOT(stopUpdate()), Qt::QueuedConnection);
     connect(this, SIGNAL(appClosing()), refresh, SLOT(killThread()));
-    refreshThread->start();
+    connect(refresh, SIGNAL(frameDue()), clsLibManager, SLOT(updateAnimatedItems()));
+    refresh->start();
 
     music = Phonon::createPlayer(Phonon::MusicCategory);
     playSound(mainData->getRightSound());
@@ -23,6 +23,7 @@ public:
     ~GameEngine();
 
     void createScene();
+    GameData* getGameData();
 
 public slots:
      void errorString(QString sErr);
@@ -33,13 +34,13 @@ signals:
 
 private:
     QGraphicsScene* mainScene;
+    GameData* mainData;
     LibraryManager* clsLibManager;
 
     CheckCategorisation* collision;
     QThread* collisionThread;
 
     RefreshScreen* refresh;
-    QThread* refreshThread;
 
     QFile fiSoundFile;
     bool bUpdateScreen;
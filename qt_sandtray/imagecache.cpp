@@ -0,0 +1,133 @@
+#include "imagecache.h"
+
+ImageCache::ImageCache()
+{
+    miHits = 0;
+    miMisses = 0;
+    miEvictions = 0;
+    setBudgetMB(512);
+}
+
+ImageCache* ImageCache::globalInstance()
+{
+    static ImageCache cache;
+    return &cache;
+}
+
+void ImageCache::setBudgetMB(int iBudgetMB)
+{
+    QMutexLocker locker(&mutex);
+    int iCount = mEntries.count();
+    mEntries.setMaxCost(qMax(iBudgetMB, 0) * 1024);
+    miEvictions += iCount - mEntries.count();
+}
+
+// the cached image if the file hasn't changed since, otherwise decode it and keep the result
+// images bigger than qsMaxSize are shrunk to fit before they are kept - an invalid size keeps them as they are
+QImage ImageCache::getImage(const QString &sFile, const QDateTime &qdtModified, QSize qsMaxSize)
+{
+    {
+        QMutexLocker locker(&mutex);
+        Entry* entry = mEntries.object(sFile);      // also marks it as most recently used
+
+        if (entry && entry->qdtModified == qdtModified && entry->qsMaxSize == qsMaxSize)
+        {
+            miHits++;
+            return entry->qiImage;
+        }
+
+        miMisses++;
+    }
+
+    // decode outside the lock so the pool threads decode in parallel - two threads missing on the same file both decode it
+    QImage qiImage = decodeImage(sFile, qsMaxSize);
+
+    if (qiImage.isNull())
+        return qiImage;
+
+    Entry* newEntry = new Entry;
+    newEntry->qiImage = qiImage;
+    newEntry->qdtModified = qdtModified;
+    newEntry->qsMaxSize = qsMaxSize;
+
+    QMutexLocker locker(&mutex);
+    bool bReplacing = mEntries.contains(sFile);
+    int iCount = mEntries.count();
+    bool bInserted = mEntries.insert(sFile, newEntry, getCostKB(qiImage));     // takes ownership, even when too big to keep
+    int iExpected = iCount - (bReplacing ? 1 : 0) + (bInserted ? 1 : 0);
+    miEvictions += iExpected - mEntries.count();
+
+    return qiImage;
+}
+
+// for files outside the libraries - costs a stat to check the modified time
+QImage ImageCache::getImage(const QString &sFile)
+{
+    return getImage(sFile, QFileInfo(sFile).lastModified());
+}
+
+bool ImageCache::contains(const QString &sFile, const QDateTime &qdtModified, QSize qsMaxSize)
+{
+    QMutexLocker locker(&mutex);
+    Entry* entry = mEntries.object(sFile);
+    return entry && entry->qdtModified == qdtModified && entry->qsMaxSize == qsMaxSize;
+}
+
+void ImageCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    mEntries.clear();
+}
+
+qint64 ImageCache::getHits()
+{
+    QMutexLocker locker(&mutex);
+    return miHits;
+}
+qint64 ImageCache::getMisses()
+{
+    QMutexLocker locker(&mutex);
+    return miMisses;
+}
+qint64 ImageCache::getEvictions()
+{
+    QMutexLocker locker(&mutex);
+    return miEvictions;
+}
+qint64 ImageCache::getBytes()
+{
+    QMutexLocker locker(&mutex);
+    return qint64(mEntries.totalCost()) * 1024;
+}
+
+QString ImageCache::getSummary()
+{
+    QMutexLocker locker(&mutex);
+    return QString("image cache: %1 hits, %2 misses, %3 evictions, %4 images in %5 of %6 MB")
+            .arg(miHits).arg(miMisses).arg(miEvictions).arg(mEntries.count())
+            .arg(mEntries.totalCost() / 1024.0, 0, 'f', 1).arg(mEntries.maxCost() / 1024);
+}
+
+// decode and convert to the format the pixmap wants, so the GUI thread only has to upload it
+QImage ImageCache::decodeImage(const QString &sFile, QSize qsMaxSize)
+{
+    QImage qiImage(sFile);
+
+    if (qiImage.isNull())
+        return qiImage;
+
+    // smooth scaling averages the source pixels, so a big shrink doesn't alias
+    // scaled to the exact size the layout worked out from the image header, rather than left to rounding in the transform
+    if (qsMaxSize.isValid() && (qiImage.width() > qsMaxSize.width() || qiImage.height() > qsMaxSize.height()))
+        qiImage = qiImage.scaled(qiImage.size().scaled(qsMaxSize, Qt::KeepAspectRatio), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    if (qiImage.hasAlphaChannel())
+        return qiImage.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    else
+        return qiImage.convertToFormat(QImage::Format_RGB32);
+}
+
+int ImageCache::getCostKB(const QImage &qiImage)
+{
+    return qiImage.byteCount() / 1024 + 1;
+}
@@ -0,0 +1,49 @@
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <QtCore>
+#include <QImage>
+
+// decoded images shared by every library load in the process, so resets and revisited libraries skip the decoder
+// keyed on the file path - an entry is only used while the file's modified time, and the size asked for, still match
+// least recently used entries are dropped once the byte budget is exceeded; safe to call from any thread
+class ImageCache
+{
+public:
+    ImageCache();
+
+    static ImageCache* globalInstance();
+
+    void setBudgetMB(int iBudgetMB);
+
+    QImage getImage(const QString &sFile, const QDateTime &qdtModified, QSize qsMaxSize = QSize());
+    QImage getImage(const QString &sFile);
+    bool contains(const QString &sFile, const QDateTime &qdtModified, QSize qsMaxSize = QSize());
+    void clear();
+
+    qint64 getHits();
+    qint64 getMisses();
+    qint64 getEvictions();
+    qint64 getBytes();
+    QString getSummary();
+
+    static QImage decodeImage(const QString &sFile, QSize qsMaxSize = QSize());
+
+private:
+    struct Entry
+    {
+        QImage qiImage;
+        QDateTime qdtModified;
+        QSize qsMaxSize;            // what it was shrunk to fit - a different limit has to decode again
+    };
+
+    static int getCostKB(const QImage &qiImage);
+
+    QMutex mutex;                   // only held for lookups and inserts - never while decoding
+    QCache<QString, Entry> mEntries;    // costs are in KB, as QCache counts in ints
+    qint64 miHits;
+    qint64 miMisses;
+    qint64 miEvictions;
+};
+
+#endif // IMAGECACHE_H
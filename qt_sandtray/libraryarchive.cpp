@@ -0,0 +1,312 @@
+#include "libraryarchive.h"
+#include "imagecache.h"
+
+const quint32 _ARCHIVE_MAGIC_ = 0x5354504b;    // "STPK"
+const quint32 _ARCHIVE_VERSION_ = 1;
+const int _BLOCK_ALIGNMENT_ = 16;
+
+QMutex LibraryArchive::mutex;
+QHash<QString, QSharedPointer<LibraryArchive> > LibraryArchive::mArchives;
+QList<QSharedPointer<LibraryArchive> > LibraryArchive::mRetired;
+
+LibraryArchive::LibraryArchive()
+{
+    mpData = 0;
+    miMappedSize = 0;
+}
+
+LibraryArchive::~LibraryArchive()
+{
+    if (mpData)
+        mFile.unmap(mpData);
+}
+
+// decode every image of a library folder and write them, with the folder's metadata, into one archive - run offline with --pack
+bool LibraryArchive::pack(const QString &sFolder, const QString &sArchive, bool bCompress)
+{
+    QFileInfo fiFolder(sFolder);
+
+    if (!fiFolder.isDir())
+    {
+        qDebug() << "Can't pack" << sFolder << "- not a library folder.";
+        return false;
+    }
+
+    LibraryIndex::LibraryEntry library;
+    library.sFolder = fiFolder.fileName();
+    LibraryIndex::scanFolder(fiFolder.absoluteFilePath(), library);
+
+    QList<QByteArray> pixelBlocks;
+    QList<Block> blocks;
+
+    // blocks go in the same order the library is loaded in - categories, then images
+    for (int iImage = 0; iImage < library.categories.count() + library.images.count(); iImage++)
+    {
+        bool bCategory = iImage < library.categories.count();
+        LibraryIndex::ImageEntry &image = bCategory ? library.categories[iImage] : library.images[iImage - library.categories.count()];
+
+        QImage qiImage = ImageCache::decodeImage(fiFolder.absoluteFilePath() + "/" + image.sFileName);
+
+        if (qiImage.isNull())
+        {
+            qDebug() << "Can't pack" << sFolder << "- failed to decode" << image.sFileName;
+            return false;
+        }
+
+        QByteArray pixels(reinterpret_cast<const char*>(qiImage.constBits()), qiImage.byteCount());
+        if (bCompress)
+            pixels = qCompress(pixels);
+
+        Block block;
+        block.iOffset = 0;
+        block.iWidth = qiImage.width();
+        block.iHeight = qiImage.height();
+        block.iBytesPerLine = qiImage.bytesPerLine();
+        block.iFormat = qiImage.format();
+        block.iStoredBytes = pixels.size();
+        block.bCompressed = bCompress;
+
+        image.qsSize = qiImage.size();
+        image.iArchiveBlock = iImage;
+
+        blocks.append(block);
+        pixelBlocks.append(pixels);
+    }
+
+    // the header is the same size whatever the offsets are, so write it once to measure, then again with them filled in
+    qint64 iOffset = writeHeader(library, blocks).size();
+
+    for (int iBlock = 0; iBlock < blocks.count(); iBlock++)
+    {
+        iOffset = (iOffset + _BLOCK_ALIGNMENT_ - 1) / _BLOCK_ALIGNMENT_ * _BLOCK_ALIGNMENT_;
+        blocks[iBlock].iOffset = iOffset;
+        iOffset += blocks.at(iBlock).iStoredBytes;
+    }
+
+    // written aside and renamed over the old archive - a running game may have the old one mapped, and keeps reading that file
+    QTemporaryFile archiveFile(sArchive + ".XXXXXX");
+
+    if (!archiveFile.open())
+    {
+        qDebug() << "Can't write" << sArchive;
+        return false;
+    }
+
+    archiveFile.write(writeHeader(library, blocks));
+
+    for (int iBlock = 0; iBlock < blocks.count(); iBlock++)
+    {
+        archiveFile.write(QByteArray(int(blocks.at(iBlock).iOffset - archiveFile.pos()), '\0'));     // padding up to the alignment
+        archiveFile.write(pixelBlocks.at(iBlock));
+    }
+
+    qint64 iArchiveSize = archiveFile.size();
+    bool bWritten = archiveFile.error() == QFile::NoError;
+    archiveFile.close();
+
+    if (!bWritten)
+    {
+        qDebug() << "Can't write" << sArchive;
+        return false;
+    }
+
+    QFile::remove(sArchive);                        // Qt won't rename over an existing file
+    if (!archiveFile.rename(sArchive))
+    {
+        qDebug() << "Can't write" << sArchive;
+        return false;
+    }
+
+    archiveFile.setAutoRemove(false);               // it is the archive now
+    qDebug() << "Packed" << blocks.count() << "images from" << sFolder << "into" << sArchive << ":" << iArchiveSize / 1024 << "KB";
+
+    return true;
+}
+
+// the library's metadata, without touching the pixels - false if it isn't an archive this build can read
+bool LibraryArchive::readLibrary(const QString &sArchive, LibraryIndex::LibraryEntry &library)
+{
+    QFile archiveFile(sArchive);
+
+    if (!archiveFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QList<Block> blocks;
+    return readHeader(&archiveFile, library, blocks);
+}
+
+// one image of an archive - mapped the first time any of its images is asked for; safe to call from the pool threads
+// an archive repacked since it was mapped is mapped again; the old mapping is kept until no image built over it is left
+QImage LibraryArchive::getImage(const QString &sArchive, const QDateTime &qdtModified, int iBlock)
+{
+    QSharedPointer<LibraryArchive> archive;         // keeps the mapping alive while the block is read, even if it is replaced meanwhile
+
+    {
+        QMutexLocker locker(&mutex);
+
+        for (int iRetired = mRetired.count() - 1; iRetired >= 0; iRetired--)
+        {
+            if (!mRetired.at(iRetired)->isInUse())
+                mRetired.removeAt(iRetired);        // unmapped once any reader still holding it lets go
+        }
+
+        archive = mArchives.value(sArchive);
+
+        if (archive && (archive->mqdtModified != qdtModified || archive->mFile.size() != archive->miMappedSize))
+        {
+            mRetired.append(mArchives.take(sArchive));
+            archive.clear();
+        }
+
+        if (!archive)
+        {
+            archive = QSharedPointer<LibraryArchive>(new LibraryArchive());
+
+            if (!archive->open(sArchive, qdtModified))
+            {
+                qDebug() << "Can't map library archive" << sArchive;
+                return QImage();
+            }
+
+            mArchives.insert(sArchive, archive);
+        }
+
+        // taken under the lock, so the image counts as in use before the archive could be retired and swept
+        QImage qiMapped = archive->getMappedBlock(iBlock);
+        if (!qiMapped.isNull())
+            return qiMapped;
+    }
+
+    return archive->getCompressedBlock(iBlock);
+}
+
+// the header has already been checked against the file size, so every block lies inside the mapping
+bool LibraryArchive::open(const QString &sArchive, const QDateTime &qdtModified)
+{
+    mFile.setFileName(sArchive);
+    mqdtModified = qdtModified;
+
+    if (!mFile.open(QIODevice::ReadOnly))
+        return false;
+
+    LibraryIndex::LibraryEntry library;
+    if (!readHeader(&mFile, library, mBlocks))
+        return false;
+
+    miMappedSize = mFile.size();
+    mpData = mFile.map(0, miMappedSize);
+    mMappedImages.resize(mBlocks.count());
+
+    return mpData != 0;
+}
+
+// uncompressed blocks point into the mapping - Qt copies them only if something writes to the image; null for compressed blocks
+// they are handed out as copies of the one image per block kept here, so its reference count says whether any are still alive
+// called with the mutex held
+QImage LibraryArchive::getMappedBlock(int iBlock)
+{
+    if (iBlock < 0 || iBlock >= mBlocks.count() || mBlocks.at(iBlock).bCompressed)
+        return QImage();
+
+    const Block &block = mBlocks.at(iBlock);
+
+    if (mMappedImages.at(iBlock).isNull())
+        mMappedImages[iBlock] = QImage(mpData + block.iOffset, block.iWidth, block.iHeight, block.iBytesPerLine, QImage::Format(block.iFormat));
+
+    return mMappedImages.at(iBlock);
+}
+
+// uncompressed into an image of its own, so nothing is left pointing into the mapping - no lock needed
+QImage LibraryArchive::getCompressedBlock(int iBlock) const
+{
+    if (iBlock < 0 || iBlock >= mBlocks.count() || !mBlocks.at(iBlock).bCompressed)
+        return QImage();
+
+    const Block &block = mBlocks.at(iBlock);
+    const uchar* pBlockData = mpData + block.iOffset;
+
+    QByteArray pixels = qUncompress(pBlockData, block.iStoredBytes);
+    QImage qiImage(block.iWidth, block.iHeight, QImage::Format(block.iFormat));
+
+    if (qiImage.isNull() || pixels.size() != qiImage.byteCount())
+        return QImage();
+
+    memcpy(qiImage.bits(), pixels.constData(), pixels.size());
+    return qiImage;
+}
+
+// true while an image over the mapping is held outside the archive - called with the mutex held
+bool LibraryArchive::isInUse() const
+{
+    foreach (const QImage &qiMapped, mMappedImages)
+    {
+        if (!qiMapped.isNull() && !qiMapped.isDetached())
+            return true;
+    }
+
+    return false;
+}
+
+bool LibraryArchive::readHeader(QIODevice* device, LibraryIndex::LibraryEntry &library, QList<Block> &blocks)
+{
+    QDataStream in(device);
+    in.setVersion(QDataStream::Qt_4_8);
+
+    quint32 iMagic, iVersion;
+    quint8 iByteOrder;
+    qint32 iBlocks;
+    in >> iMagic >> iVersion >> iByteOrder;
+
+    // pixels are stored as they are in memory, so an archive packed on a machine of the other byte order can't be used
+    if (iMagic != _ARCHIVE_MAGIC_ || iVersion != _ARCHIVE_VERSION_ || iByteOrder != quint8(QSysInfo::ByteOrder))
+        return false;
+
+    in >> library >> iBlocks;
+
+    blocks.clear();
+    for (int iBlock = 0; iBlock < iBlocks && in.status() == QDataStream::Ok; iBlock++)
+    {
+        Block block;
+        in >> block.iOffset >> block.iWidth >> block.iHeight >> block.iBytesPerLine >> block.iFormat >> block.iStoredBytes >> block.bCompressed;
+
+        if (!checkBlock(block, device->size()))
+            return false;               // damaged or truncated - the library is read from its folder instead
+
+        blocks.append(block);
+    }
+
+    return in.status() == QDataStream::Ok && blocks.count() == library.categories.count() + library.images.count();
+}
+
+// a block has to describe an image this build writes, and lie wholly inside the file - images are built straight over the mapping
+bool LibraryArchive::checkBlock(const Block &block, qint64 iFileSize)
+{
+    if (block.iFormat != QImage::Format_ARGB32_Premultiplied && block.iFormat != QImage::Format_RGB32)
+        return false;
+
+    if (block.iWidth <= 0 || block.iHeight <= 0 || block.iBytesPerLine < qint64(block.iWidth) * 4 || block.iBytesPerLine % 4 != 0)
+        return false;
+
+    if (block.iOffset < 0 || block.iStoredBytes < 0 || block.iOffset + block.iStoredBytes > iFileSize)
+        return false;
+
+    // compressed blocks are checked against the image size once they are uncompressed
+    if (!block.bCompressed && (qint64(block.iBytesPerLine) * block.iHeight > block.iStoredBytes || block.iOffset % 4 != 0))
+        return false;
+
+    return true;
+}
+
+QByteArray LibraryArchive::writeHeader(const LibraryIndex::LibraryEntry &library, const QList<Block> &blocks)
+{
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_8);
+
+    out << _ARCHIVE_MAGIC_ << _ARCHIVE_VERSION_ << quint8(QSysInfo::ByteOrder) << library << qint32(blocks.count());
+
+    foreach (Block block, blocks)
+        out << block.iOffset << block.iWidth << block.iHeight << block.iBytesPerLine << block.iFormat << block.iStoredBytes << block.bCompressed;
+
+    return header;
+}
@@ -0,0 +1,55 @@
+#ifndef LIBRARYARCHIVE_H
+#define LIBRARYARCHIVE_H
+
+#include <QtCore>
+#include <QImage>
+
+#include "libraryindex.h"
+
+// a whole library in one file - the metadata parsed from the file names, then every image already decoded
+// pixel blocks are premultiplied ARGB32 or RGB32 in this machine's byte order, optionally compressed with qCompress
+// uncompressed blocks are used straight from the memory mapped file, so loading them is neither a decode nor a copy
+class LibraryArchive
+{
+public:
+    static bool pack(const QString &sFolder, const QString &sArchive, bool bCompress);
+    static bool readLibrary(const QString &sArchive, LibraryIndex::LibraryEntry &library);
+    static QImage getImage(const QString &sArchive, const QDateTime &qdtModified, int iBlock);
+
+   ~LibraryArchive();                   // for QSharedPointer - archives are only made by getImage
+
+private:
+    struct Block
+    {
+        qint64 iOffset;                 // from the start of the file
+        qint32 iWidth;
+        qint32 iHeight;
+        qint32 iBytesPerLine;
+        qint32 iFormat;                 // QImage::Format
+        qint32 iStoredBytes;
+        bool bCompressed;
+    };
+
+    LibraryArchive();
+
+    bool open(const QString &sArchive, const QDateTime &qdtModified);
+    QImage getMappedBlock(int iBlock);
+    QImage getCompressedBlock(int iBlock) const;
+    bool isInUse() const;
+    static bool readHeader(QIODevice* device, LibraryIndex::LibraryEntry &library, QList<Block> &blocks);
+    static bool checkBlock(const Block &block, qint64 iFileSize);
+    static QByteArray writeHeader(const LibraryIndex::LibraryEntry &library, const QList<Block> &blocks);
+
+    QFile mFile;
+    uchar* mpData;                      // the whole file, mapped until the archive is repacked - images point into it
+    qint64 miMappedSize;
+    QDateTime mqdtModified;             // from the index, when it was mapped
+    QList<Block> mBlocks;
+    QVector<QImage> mMappedImages;      // one per uncompressed block, over the mapping - every image handed out is a copy of one
+
+    static QMutex mutex;                // guards the open archives and their mapped images - images are read from the pool threads
+    static QHash<QString, QSharedPointer<LibraryArchive> > mArchives;  // by path - a repacked file replaces the old mapping
+    static QList<QSharedPointer<LibraryArchive> > mRetired;            // replaced, but images over them are still alive
+};
+
+#endif // LIBRARYARCHIVE_H
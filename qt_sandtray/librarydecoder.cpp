@@ -0,0 +1,59 @@
+#include "librarydecoder.h"
+#include "libraryarchive.h"
+#include "imagecache.h"
+
+LibraryDecoder::LibraryDecoder()
+{
+}
+
+LibraryDecoder::LibraryDecoder(QSize qsMaxDisplay, QSize qsRung)
+{
+    mqsMaxDisplay = qsMaxDisplay;
+    mqsRung = qsRung;
+}
+
+// decoded images come from the process wide cache, so a reset or a library seen before doesn't decode again - runs on the thread pool
+// images from a packed archive are already decoded, and come straight from the mapped file unless they have to be shrunk
+LibraryImage LibraryDecoder::operator()(const LibraryIndex::ImageEntry &image) const
+{
+    LibraryImage decoded;
+
+    if (image.iArchiveBlock >= 0)
+    {
+        decoded.qiImage = LibraryArchive::getImage(image.sFile, image.qdtModified, image.iArchiveBlock);
+
+        QSize qsDisplay = getDisplaySize(decoded.qiImage.size(), mqsMaxDisplay);
+        if (qsDisplay != decoded.qiImage.size())
+            decoded.qiImage = decoded.qiImage.scaled(qsDisplay, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    else
+    {
+        decoded.qiImage = ImageCache::globalInstance()->getImage(image.sFile, image.qdtModified, mqsMaxDisplay);
+    }
+
+    // categories never go in a ladder
+    if (mqsRung.isValid() && !decoded.qiImage.isNull() && image.sFileName.mid(0,3).toUpper() != "CAT")
+        decoded.qiThumbnail = decoded.qiImage.scaled(mqsRung, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    return decoded;
+}
+
+// one after the other on a single pool thread - the prefetch runs during play, so it mustn't take every core
+QList<LibraryImage> LibraryDecoder::decodeAll(const QList<LibraryIndex::ImageEntry> &images) const
+{
+    QList<LibraryImage> decoded;
+
+    foreach (LibraryIndex::ImageEntry image, images)
+        decoded.append((*this)(image));
+
+    return decoded;
+}
+
+// images are shown at their own size, so only ones bigger than the screen are shrunk - keeping their shape
+QSize LibraryDecoder::getDisplaySize(QSize qsSource, QSize qsMaxDisplay)
+{
+    if (!qsMaxDisplay.isValid() || (qsSource.width() <= qsMaxDisplay.width() && qsSource.height() <= qsMaxDisplay.height()))
+        return qsSource;
+
+    return qsSource.scaled(qsMaxDisplay, Qt::KeepAspectRatio);
+}
@@ -0,0 +1,36 @@
+#ifndef LIBRARYDECODER_H
+#define LIBRARYDECODER_H
+
+#include <QtCore>
+#include <QImage>
+
+#include "libraryindex.h"
+
+// pixels for one category or image of a library - images also get a thumbnail for when they sit in a ladder rung
+struct LibraryImage
+{
+    QImage qiImage;                 // no bigger than the screen
+    QImage qiThumbnail;
+};
+
+// decodes library entries at the size they are shown, so nothing bigger is kept or scaled down while painting
+// copied to each pool thread, so it holds nothing but the sizes
+class LibraryDecoder
+{
+public:
+    typedef LibraryImage result_type;
+
+    LibraryDecoder();
+    LibraryDecoder(QSize qsMaxDisplay, QSize qsRung);
+
+    LibraryImage operator()(const LibraryIndex::ImageEntry &image) const;
+    QList<LibraryImage> decodeAll(const QList<LibraryIndex::ImageEntry> &images) const;
+
+    static QSize getDisplaySize(QSize qsSource, QSize qsMaxDisplay);
+
+private:
+    QSize mqsMaxDisplay;
+    QSize mqsRung;                  // largest ladder rung of the library - invalid if it has no categories
+};
+
+#endif // LIBRARYDECODER_H
@@ -0,0 +1,372 @@
+#include "libraryindex.h"
+#include "libraryarchive.h"
+
+const quint32 _INDEX_MAGIC_ = 0x53544958;      // "STIX"
+const quint32 _INDEX_VERSION_ = 2;
+const QString _INDEX_FOLDER_ = ".sandtray";         // in the library root, but never taken for a library
+
+// QDateTime is saved as milliseconds so a modified time read back compares equal to the one from the file system
+QDataStream &operator<<(QDataStream &out, const LibraryIndex::ImageEntry &image)
+{
+    out << image.sFileName << image.sProps << image.sCategory << image.qsSize << image.qdtModified.toMSecsSinceEpoch()
+        << qint32(image.iArchiveBlock);
+    return out;
+}
+QDataStream &operator>>(QDataStream &in, LibraryIndex::ImageEntry &image)
+{
+    qint64 iModified;
+    qint32 iArchiveBlock;
+    in >> image.sFileName >> image.sProps >> image.sCategory >> image.qsSize >> iModified >> iArchiveBlock;
+    image.qdtModified = QDateTime::fromMSecsSinceEpoch(iModified);
+    image.iArchiveBlock = iArchiveBlock;
+    return in;
+}
+QDataStream &operator<<(QDataStream &out, const LibraryIndex::LibraryEntry &library)
+{
+    out << library.sFolder << library.sArchive << library.qdtModified.toMSecsSinceEpoch() << library.sProps << library.bTurnTake
+        << library.categories << library.images;
+    return out;
+}
+QDataStream &operator>>(QDataStream &in, LibraryIndex::LibraryEntry &library)
+{
+    qint64 iModified;
+    in >> library.sFolder >> library.sArchive >> iModified >> library.sProps >> library.bTurnTake >> library.categories >> library.images;
+    library.qdtModified = QDateTime::fromMSecsSinceEpoch(iModified);
+    return in;
+}
+
+LibraryIndex::LibraryIndex()
+{
+    miLibrariesScanned = 0;
+}
+
+// read the saved index, then list the root again only if it has changed - libraries that went away are dropped
+// and new ones are added unscanned, to be read the first time they are loaded
+// a library packed with --pack is used in place of a folder of the same name
+void LibraryIndex::open(const QString &sLibRoot)
+{
+    msLibRoot = sLibRoot;
+    mLibraries.clear();
+
+    bool bRead = readIndex();
+    QDateTime qdtRootModified = QFileInfo(msLibRoot).lastModified();
+
+    if (bRead && qdtRootModified == mqdtRootModified)
+        return;
+
+    QHash<QString, LibraryEntry> oldLibraries;
+    foreach (LibraryEntry library, mLibraries)
+        oldLibraries.insert(library.sFolder, library);
+
+    mLibraries.clear();
+
+    QDir rootDir(msLibRoot);
+    QStringList slFolders = rootDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    slFolders.removeAll(_INDEX_FOLDER_);            // not hidden on Windows
+    QSet<QString> archives;
+
+    foreach (QString sArchive, rootDir.entryList(QStringList("*.pack"), QDir::Files))
+    {
+        QString sFolder = sArchive.left(sArchive.length() - 5);
+        archives.insert(sFolder);
+
+        if (!slFolders.contains(sFolder))
+            slFolders.append(sFolder);
+    }
+
+    slFolders.sort();                   // ids follow the names, whether folder or archive
+
+    foreach (QString sFolder, slFolders)
+    {
+        QString sArchive = archives.contains(sFolder) ? sFolder + ".pack" : QString();
+
+        if (oldLibraries.contains(sFolder) && oldLibraries.value(sFolder).sArchive == sArchive)
+        {
+            mLibraries.append(oldLibraries.value(sFolder));
+        }
+        else
+        {
+            LibraryEntry library;
+            library.sFolder = sFolder;
+            library.sArchive = sArchive;
+            library.bTurnTake = false;
+            mLibraries.append(library);      // no modified time, so scanned on first use
+        }
+    }
+
+    mqdtRootModified = qdtRootModified;
+    writeIndex();
+}
+
+int LibraryIndex::getLibraryCount() const
+{
+    return mLibraries.count();
+}
+
+int LibraryIndex::getLibrariesScanned() const
+{
+    return miLibrariesScanned;
+}
+
+// the library with absolute paths filled in - costs one stat of its folder or archive, and of each image file in a folder
+// only what changed is read again: the whole library if its folder or archive did, otherwise just the images overwritten in place
+// images in an archive all point at the archive, with its modified time, so the archive is mapped again if it is repacked
+bool LibraryIndex::getLibrary(int iLibraryId, LibraryEntry &library)
+{
+    if (iLibraryId < 0 || iLibraryId >= mLibraries.count())
+        return false;
+
+    LibraryEntry &entry = mLibraries[iLibraryId];
+    QFileInfo fiLibrary(getLibraryFile(entry));
+
+    if (!fiLibrary.exists())
+        return false;
+
+    if (fiLibrary.lastModified() != entry.qdtModified)
+    {
+        entry.qdtModified = fiLibrary.lastModified();
+        scanLibrary(entry);
+        writeIndex();
+
+        fiLibrary = QFileInfo(getLibraryFile(entry));     // a bad archive falls back to the folder
+        if (!fiLibrary.exists())
+            return false;
+    }
+    else if (entry.sArchive.isEmpty() && refreshImages(entry))
+    {
+        writeIndex();
+    }
+
+    library = entry;
+
+    QList<ImageEntry*> images;
+    for (int iCat = 0; iCat < library.categories.count(); iCat++)
+        images.append(&library.categories[iCat]);
+    for (int iImage = 0; iImage < library.images.count(); iImage++)
+        images.append(&library.images[iImage]);
+
+    foreach (ImageEntry* image, images)
+    {
+        if (image->iArchiveBlock >= 0)
+        {
+            image->sFile = fiLibrary.absoluteFilePath();
+            image->qdtModified = library.qdtModified;
+        }
+        else
+        {
+            image->sFile = fiLibrary.absoluteFilePath() + "/" + image->sFileName;
+        }
+    }
+
+    return true;
+}
+
+// read the metadata from the archive header or the folder - an archive that can't be read falls back to a folder of the same name
+void LibraryIndex::scanLibrary(LibraryEntry &library)
+{
+    miLibrariesScanned++;
+
+    if (!library.sArchive.isEmpty())
+    {
+        LibraryEntry packed;
+
+        if (LibraryArchive::readLibrary(msLibRoot + library.sArchive, packed))
+        {
+            // named after the archive, even if it was packed from a folder called something else
+            library.sProps = extractLibraryProps(library.sFolder);
+            library.bTurnTake = extractLibraryTurnTakeMode(library.sFolder);
+            library.categories = packed.categories;
+            library.images = packed.images;
+            return;
+        }
+
+        qDebug() << "Library archive" << library.sArchive << "can't be read - using the folder instead.";
+        library.sArchive.clear();
+        library.qdtModified = QFileInfo(getLibraryFile(library)).lastModified();
+    }
+
+    scanFolder(msLibRoot + library.sFolder, library);
+}
+
+// an image overwritten in place leaves its folder's modified time alone, so each file is checked against the time it was read at
+// changed images get their size from the header again, so the layout and the image cache both see the new file
+// true if anything changed; a file that has gone means the whole folder is read again
+bool LibraryIndex::refreshImages(LibraryEntry &library)
+{
+    QString sPath = msLibRoot + library.sFolder + "/";
+    bool bChanged = false;
+
+    QList<ImageEntry*> images;
+    for (int iCat = 0; iCat < library.categories.count(); iCat++)
+        images.append(&library.categories[iCat]);
+    for (int iImage = 0; iImage < library.images.count(); iImage++)
+        images.append(&library.images[iImage]);
+
+    foreach (ImageEntry* image, images)
+    {
+        QFileInfo fiImage(sPath + image->sFileName);
+
+        if (!fiImage.exists())
+        {
+            scanLibrary(library);
+            return true;
+        }
+
+        if (fiImage.lastModified() != image->qdtModified)
+        {
+            image->qsSize = QImageReader(fiImage.absoluteFilePath()).size();
+            image->qdtModified = fiImage.lastModified();
+            bChanged = true;
+        }
+    }
+
+    return bChanged;
+}
+
+QString LibraryIndex::getLibraryFile(const LibraryEntry &library) const
+{
+    if (library.sArchive.isEmpty())
+        return msLibRoot + library.sFolder;
+    else
+        return msLibRoot + library.sArchive;
+}
+
+// read the names and image headers of one library folder - only png or jpg files
+void LibraryIndex::scanFolder(const QString &sPath, LibraryEntry &library)
+{
+    QDir libDir(sPath);
+    QStringList nameFilter;
+    nameFilter << "*.png" << "*.jpg";
+
+    library.sProps = extractLibraryProps(library.sFolder);
+    library.bTurnTake = extractLibraryTurnTakeMode(library.sFolder);
+    library.categories.clear();
+    library.images.clear();
+
+    // categories go first so when we add the images, we know where they are and don't overlap
+    foreach (QFileInfo fiImage, libDir.entryInfoList(nameFilter, QDir::Files))
+    {
+        ImageEntry image;
+        image.sFileName = fiImage.fileName();
+        image.sProps = extractImageProps(image.sFileName);
+        image.qsSize = QImageReader(fiImage.absoluteFilePath()).size();
+        image.qdtModified = fiImage.lastModified();
+        image.iArchiveBlock = -1;
+
+        if (image.sFileName.mid(0,3).toUpper() == "CAT")
+        {
+            image.sCategory = image.sFileName.mid(3,1).toUpper();   // first 3 are 'cat', next letter is name
+            library.categories.append(image);
+        }
+        else
+        {
+            image.sCategory = image.sFileName.mid(0,1).toUpper();   // first character is the category
+            library.images.append(image);
+        }
+    }
+}
+
+bool LibraryIndex::readIndex()
+{
+    QFile indexFile(getIndexFile());
+
+    if (!indexFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&indexFile);
+    in.setVersion(QDataStream::Qt_4_8);
+
+    quint32 iMagic, iVersion;
+    qint64 iRootModified;
+    in >> iMagic >> iVersion;
+
+    if (iMagic != _INDEX_MAGIC_ || iVersion != _INDEX_VERSION_)
+        return false;
+
+    in >> iRootModified >> mLibraries;
+    mqdtRootModified = QDateTime::fromMSecsSinceEpoch(iRootModified);
+
+    if (in.status() != QDataStream::Ok)
+    {
+        qDebug() << "Library index" << getIndexFile() << "is damaged - rebuilding it.";
+        mLibraries.clear();
+        return false;
+    }
+
+    return true;
+}
+
+// written to a temporary file and renamed over the index, so no reader - on this machine or another sharing the root - sees half of one
+// it has its own folder, so replacing it doesn't change the root's modified time and force a new listing next start
+// a root that can't be written to is left alone - the index is then only kept in memory
+void LibraryIndex::writeIndex()
+{
+    if (!QFileInfo(msLibRoot).isWritable())
+        return;
+
+    QDir rootDir(msLibRoot);
+    if (!rootDir.exists(_INDEX_FOLDER_))
+    {
+        if (!rootDir.mkdir(_INDEX_FOLDER_))
+        {
+            qDebug() << "Library index could not be saved to" << msLibRoot;
+            return;
+        }
+
+        mqdtRootModified = QFileInfo(msLibRoot).lastModified();     // creating the index is the change, not a new library
+    }
+
+    QTemporaryFile tempFile(getIndexFile() + ".XXXXXX");
+    if (!tempFile.open())
+    {
+        qDebug() << "Library index could not be saved to" << msLibRoot;
+        return;
+    }
+
+    QDataStream out(&tempFile);
+    out.setVersion(QDataStream::Qt_4_8);
+    out << _INDEX_MAGIC_ << _INDEX_VERSION_ << mqdtRootModified.toMSecsSinceEpoch() << mLibraries;
+    tempFile.close();
+
+    QFile::remove(getIndexFile());                  // Qt won't rename over an existing file
+    if (tempFile.rename(getIndexFile()))
+        tempFile.setAutoRemove(false);              // it is the index now
+    else
+        qDebug() << "Library index could not be saved to" << msLibRoot;
+}
+
+// in its own folder, so the directory listing of the root doesn't take it for a library
+QString LibraryIndex::getIndexFile() const
+{
+    return msLibRoot + _INDEX_FOLDER_ + "/library.index";
+}
+
+// get the image properties from the filename - use underscore delimiter
+QString LibraryIndex::extractImageProps(const QString &sFileName)
+{
+    QRegExp rx("(\\_|\\.)"); //RegEx for '.' or '_'
+    QStringList splitString = sFileName.split(rx);
+
+    splitString.removeAt(0);                        // remove cat/id at start
+    splitString.removeAt(splitString.count() - 1);  // remove file type at end
+
+    return splitString.join("_");
+}
+
+// get the library properties from the foldername - use underscore delimiter
+QString LibraryIndex::extractLibraryProps(const QString &sFolder)
+{
+    QStringList splitString = sFolder.split("_");
+    splitString.removeAt(0);        // remove lib UID from start
+    splitString.removeAt(1);        // remove lib mode
+    return splitString.join("_");   // rejoin props to be unpacked by robot
+}
+
+bool LibraryIndex::extractLibraryTurnTakeMode(const QString &sFolder)
+{
+    QStringList splitString = sFolder.split("_");
+    if (splitString.at(1) == "mode0")
+        return false;
+    else
+        return true;
+}
@@ -0,0 +1,67 @@
+#ifndef LIBRARYINDEX_H
+#define LIBRARYINDEX_H
+
+#include <QtCore>
+#include <QImageReader>
+
+// what a load needs from the library folders - names, properties parsed from them and image sizes
+// saved next to the libraries so a load reads one small file; a library is only rescanned when its folder has changed,
+// and an image file only read again when its own modified time has
+class LibraryIndex
+{
+public:
+    struct ImageEntry
+    {
+        QString sFileName;
+        QString sFile;                  // absolute path - filled in when the library is handed out, not saved
+        QString sProps;                 // properties from the file name
+        QString sCategory;              // letter of the category the image belongs to, or the category's own letter
+        QSize qsSize;                   // from the image header
+        QDateTime qdtModified;
+        int iArchiveBlock;              // pixel block in the library's archive, -1 for an image file
+    };
+
+    struct LibraryEntry
+    {
+        QString sFolder;
+        QString sArchive;               // packed archive in the root, used instead of the folder - empty if there isn't one
+        QDateTime qdtModified;          // of the folder or archive - a folder's changes when files are added, removed or renamed
+        QString sProps;                 // properties from the folder name
+        bool bTurnTake;                 // mode from the folder name
+        QList<ImageEntry> categories;
+        QList<ImageEntry> images;
+    };
+
+    LibraryIndex();
+
+    void open(const QString &sLibRoot);
+    int getLibraryCount() const;
+    bool getLibrary(int iLibraryId, LibraryEntry &library);
+    int getLibrariesScanned() const;
+
+    static void scanFolder(const QString &sPath, LibraryEntry &library);
+
+    static QString extractImageProps(const QString &sFileName);
+    static QString extractLibraryProps(const QString &sFolder);
+    static bool extractLibraryTurnTakeMode(const QString &sFolder);
+
+private:
+    bool readIndex();
+    void writeIndex();
+    void scanLibrary(LibraryEntry &library);
+    bool refreshImages(LibraryEntry &library);
+    QString getLibraryFile(const LibraryEntry &library) const;
+    QString getIndexFile() const;
+
+    QString msLibRoot;
+    QDateTime mqdtRootModified;         // the folder list is only read again when the root folder changes
+    QList<LibraryEntry> mLibraries;     // in folder name order, which gives the library ids
+    int miLibrariesScanned;             // folders read since start up - for the performance stats
+};
+
+QDataStream &operator<<(QDataStream &out, const LibraryIndex::ImageEntry &image);
+QDataStream &operator>>(QDataStream &in, LibraryIndex::ImageEntry &image);
+QDataStream &operator<<(QDataStream &out, const LibraryIndex::LibraryEntry &library);
+QDataStream &operator>>(QDataStream &in, LibraryIndex::LibraryEntry &library);
+
+#endif // LIBRARYINDEX_H
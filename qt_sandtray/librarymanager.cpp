@@ -7,11 +7,31 @@ LibraryManager::LibraryManager(QGraphicsScene &sceneIn, GameData &dataIn)
     msLibRoot = mGameData->getLibraryPath();
     mGameData->setLibraryId(-1);        // init at -1 as we call nextLibrary() to bring up a new lib, making start lib0
 
-    if (!mGameData->getLibraryTestReserved())
-        mGameData->setLibraryLimit(QDir(msLibRoot).entryList(QDir::Dirs | QDir::NoDotAndDotDot).count());
+    mIndex.open(msLibRoot);             // the saved index, so loads don't list the folders again
 
+    if (!mGameData->getLibraryTestReserved())
+        mGameData->setLibraryLimit(mIndex.getLibraryCount());
+
+    ImageCache::globalInstance()->setBudgetMB(mGameData->getImageCacheMB());
+
+    miShownLibrary = -1;
+    miLibraryBuilds = 0;
+    miAheadBuild = -1;
+    mbAheadPending = false;
+    mPrefetch.iLibraryId = -1;
+    mbAdoptPrefetch = false;
+    miPrefetchHits = 0;
+    miPrefetchMisses = 0;
+
+    QObject::connect(&mDecodeWatcher, SIGNAL(finished()), this, SLOT(libraryDecoded()));
+    QObject::connect(&mPrefetchWatcher, SIGNAL(finished()), this, SLOT(prefetchDecoded()));
+    QObject::connect(&mAheadWatcher, SIGNAL(finished()), this, SLOT(aheadDecoded()));
     QObject::connect(mGameData, SIGNAL(newGame()), this, SLOT(nextLibrary()));
     QObject::connect(mGameData, SIGNAL(resetGame()), this, SLOT(reloadCurrentLibrary()));
+    QObject::connect(mGameData, SIGNAL(imageChanged(int)), this, SLOT(updateImage(int)), Qt::QueuedConnection);
+    QObject::connect(mGameData, SIGNAL(categoryChanged(int)), this, SLOT(updateCategory(int)), Qt::QueuedConnection);
+    QObject::connect(mGameData, SIGNAL(sceneChanged()), this, SLOT(updateScene()), Qt::QueuedConnection);
+    QObject::connect(mGameData, SIGNAL(oneToShowChanged()), this, SLOT(decodeAhead()), Qt::QueuedConnection);
 }
 
 LibraryManager::~LibraryManager()
@@ -34,178 +54,584 @@ void LibraryManager::nextLibrary()
 
 void LibraryManager::reloadCurrentLibrary()
 {
-    loadLibrary();
+    // the library asked for is the one on screen, so keep its items and only put them back to the start
+    if (mGameData->getIncrementalReset() && mGameData->getLibraryId() == miShownLibrary && !mDecodeWatcher.isRunning())
+        resetLibrary();
+    else
+        loadLibrary();
+}
+
+// reset the library on screen in place - images are placed again and lose their state, but no item or pixmap is recreated
+void LibraryManager::resetLibrary()
+{
+    QElapsedTimer resetTimer;
+    resetTimer.start();
+    mGameData->setLibraryFailed(false);
+
+    int iTotalImgs = mImages.length();
+    bool bTurnTake = mGameData->getTurnTakeMode();
+    bool bCentre = getCentreImages(mGameData->getOneAtATime(), mCategories.length());
+
+    // the categories stay where they are
+    PlacementEngine placement = createPlacementEngine();
+    foreach (GameData::CategoryDetails category, mGameData->getCatDetails())
+        placement.block(SpatialGrid::boundsAround(category.qpfCatPosition, category.qsCatSize));
+    int iSpacing = mGameData->getImageSpacing();
+
+    // sizes don't change with a reset, so read them once rather than per image
+    const QVector<QSize> qsImageSizes = mGameData->getImageHotState().qsSizes;
+    QVector<QPointF> qpfPositions(iTotalImgs);
+
+    mGameData->setCollisionCheck(false);
+    mGameData->beginBoardUpdate();
+    mGameData->resetBoardState();
+
+    for (int iImgCounter = 0; iImgCounter < iTotalImgs && iImgCounter < qsImageSizes.size(); iImgCounter++)
+    {
+        QSize qsImageSize = qsImageSizes.at(iImgCounter);
+        QPointF qpfPos = getImagePosition(qsImageSize.width(), qsImageSize.height(), bTurnTake, bCentre, iImgCounter, iTotalImgs, iSpacing, placement);
+        mImages.at(iImgCounter)->resetState();
+        mImages.at(iImgCounter)->setPos(qpfPos);
+        qpfPositions[iImgCounter] = qpfPos;
+    }
+
+    mGameData->setImagePositions(qpfPositions);
+
+    if (mGameData->getOneAtATime())
+    {
+        miShuffle = mGameData->getRandomShuffleLibrary(iTotalImgs);
+        mGameData->setShuffleOrder(miShuffle);
+        mGameData->setCurrOneToShow(0);
+    }
+
+    mGameData->endBoardUpdate();
+    updateScene();
+    decodeAhead();                  // images back out of the ladders only kept their thumbnails
+
+    if (mGameData->getPerformanceStats())
+        qDebug() << "Library reset in place:" << iTotalImgs << "images in" << resetTimer.nsecsElapsed() / 1000000.0 << "ms";
+
+    emit libraryLoaded();
+    mGameData->setCollisionCheck(true);
 }
 
-// loads the library specified in iCurrLib - creates the category and image objects and adds them to the scene
+// loads the library specified in iCurrLib - in stages, so the screen doesn't freeze while a big library decodes
+// 1. look it up in the index and lay it out from the image sizes (here), so the board can be reported before any pixels exist
+// 2. decode the images on the thread pool, 3. create the scene items on the GUI thread (buildLibrary)
+// if the library was prefetched, stage 3 can start straight away
 void LibraryManager::loadLibrary()
 {
     int iCurrLib = mGameData->getLibraryId();
-    mGameData->setCollisionCheck(false);     // turn off collision checking - causes a crash if on whilst library changing
+    bool bNewLibrary = (iCurrLib != miShownLibrary);     // a reset doesn't count towards the prefetch hit rate
+
+    // a newer request replaces one still decoding
+    if (mDecodeWatcher.isRunning())
+    {
+        mDecodeWatcher.cancel();
+        mDecodeWatcher.waitForFinished();
+    }
 
-    QStringList libFolders = QDir(msLibRoot).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    mbAdoptPrefetch = false;
+    mGameData->setLibraryFailed(false);
 
-    if (libFolders.count() < 1)
+    if (iCurrLib >= 0 && mPrefetch.iLibraryId == iCurrLib)
+    {
+        if (bNewLibrary)
+            miPrefetchHits++;
+
+        layoutLibrary(mPrefetch);
+
+        if (mPrefetchWatcher.isRunning())
+            mbAdoptPrefetch = true;                     // built as soon as the prefetch finishes
+        else
+            buildPrefetchedLibrary();
+
+        return;
+    }
+
+    if (bNewLibrary)
+        miPrefetchMisses++;
+
+    QElapsedTimer scanTimer;
+    scanTimer.start();
+
+    if (scanLibrary(iCurrLib, mPending))
+    {
+        layoutLibrary(mPending);
+        mPending.iScanNs = scanTimer.nsecsElapsed();
+        mPending.decodeTimer.start();
+
+        mDecodeWatcher.setFuture(QtConcurrent::mapped(selectDecodeImages(mPending), getDecoder(mPending.entry)));
+    }
+    else
+    {
+        // nothing will be laid out or built, so anyone waiting on this load has to be told now
+        mGameData->setLibraryFailed(true);
+        mGameData->setLibraryLoading(false);
+        emit libraryFailed();
+    }
+}
+
+// look the library up in the index - the folder is only read if it changed since it was indexed; false if it can't be found
+bool LibraryManager::scanLibrary(int iLibraryId, PendingLibrary &library)
+{
+    if (mIndex.getLibraryCount() < 1)
     {
         qDebug() << "No library folders found.";
+        return false;
+    }
+
+    if (!mIndex.getLibrary(iLibraryId, library.entry))
+    {
+        qDebug() << "Lib folders found, but index given was wrong.";
+        return false;
+    }
+
+    library.iLibraryId = iLibraryId;
+    library.iScanNs = 0;
+    library.iDecodeNs = 0;
+
+    return true;
+}
+
+// place the categories and images from the sizes in the index, and publish the layout before anything is decoded
+void LibraryManager::layoutLibrary(PendingLibrary &library)
+{
+    const LibraryIndex::LibraryEntry &entry = library.entry;
+    GameData::BoardLayout &layout = library.layout;
+    int iTotalCats = entry.categories.length();
+    int iTotalImgs = entry.images.length();
+    int iLadderWidth = mGameData->getLadderWidth();
+
+    // turn taking turns one-at-a-time off when the library is built
+    bool bCentre = getCentreImages(mGameData->getOneAtATime() && !entry.bTurnTake, iTotalCats);
+
+    layout = GameData::BoardLayout();
+    layout.iLibraryId = library.iLibraryId;
+    layout.sLibraryProps = entry.sProps;
+
+    // categories first so the images can avoid them - sizes are the ones the decoder will shrink to
+    PlacementEngine placement = createPlacementEngine();
+    QSize qsScreen = mGameData->getScreenSize();
+
+    for (int iCatCounter = 0; iCatCounter < iTotalCats; iCatCounter++)
+    {
+        QSize qsCatSize = LibraryDecoder::getDisplaySize(entry.categories.at(iCatCounter).qsSize, qsScreen);
+        QPointF qpfPos = getCategoryPosition(iCatCounter, iTotalCats, qsCatSize.width(), qsCatSize.height(), iLadderWidth);
+        layout.slCategoryProps.append(entry.categories.at(iCatCounter).sProps);
+        layout.qpfCategoryPositions.append(qpfPos);
+        layout.qsCategorySizes.append(qsCatSize);
+        placement.block(SpatialGrid::boundsAround(qpfPos, qsCatSize));
+    }
+
+    int iSpacing = mGameData->getImageSpacing();
+    int iCrowded = 0;
+    QElapsedTimer placementTimer;
+    placementTimer.start();
+
+    for (int iImgCounter = 0; iImgCounter < iTotalImgs; iImgCounter++)
+    {
+        QSize qsImageSize = LibraryDecoder::getDisplaySize(entry.images.at(iImgCounter).qsSize, qsScreen);
+        bool bFree = true;
+        QPointF qpfPos = getImagePosition(qsImageSize.width(), qsImageSize.height(), entry.bTurnTake, bCentre, iImgCounter, iTotalImgs, iSpacing, placement, &bFree);
+        layout.qpfImagePositions.append(qpfPos);
+        layout.qsImageSizes.append(qsImageSize);
+
+        if (!bFree)
+            iCrowded++;
+    }
+
+    if (mGameData->getPerformanceStats())
+        qDebug() << "Library" << entry.sFolder << ":" << iTotalImgs << "images placed in" << placementTimer.nsecsElapsed() / 1000000.0
+                 << "ms," << iCrowded << "with no free space left";
+
+    mGameData->setBoardLayout(layout);
+    emit libraryLaidOut();
+}
+
+// which images to decode before the library is built - all of them, unless one-at-a-time, when it is only the first few in the shuffle
+// the categories always come first, so the results line up with iDecodeImages after them
+QList<LibraryIndex::ImageEntry> LibraryManager::selectDecodeImages(PendingLibrary &library)
+{
+    int iTotalImgs = library.entry.images.length();
+
+    library.iShuffle = mGameData->getRandomShuffleLibrary(iTotalImgs);
+    library.iDecodeImages.clear();
+
+    if (getLazyDecode(library.entry.bTurnTake))
+    {
+        library.iDecodeImages = library.iShuffle.mid(0, mGameData->getDecodeAhead() + 1);
     }
     else
     {
-        QDir libDir(msLibRoot + libFolders.at(iCurrLib));
-
-        // pull in the images from the correct folder - only get png or jpg files
-        if (libDir.exists())
-        {          
-            // get number of categories - we need to have at least 1
-            int iTotalCats = getNumberOfCategoriesInLibrary(libDir);
-
-            // for the DREAM game, we often intentionally don't want categories, so remove check
-            //if (iTotalCats < 1)
-            //{
-            //    qDebug() << "No categories found in library. Please add at least 1 image file starting 'cat'.";
-            //}
-            //else
-            //{
-                mMainScene->clear();             // clear scene, also destroys objects
-                mGameData->clearImageDetails();  // clear out our data structures
-                mGameData->clearCatDetails();
-
-                QString sLibProps = extractLibraryProps(libFolders.at(iCurrLib));
-                mGameData->setLibraryProperties(sLibProps);
-
-                // read from the library name which mode we are in
-                bool bTurnTake = extractLibraryTurnTakeMode(libFolders.at(iCurrLib));
-                mGameData->setTurnTakeMode(bTurnTake);
-                if (bTurnTake)
-                    mGameData->setOneAtATime(false);
-
-                if (mGameData->getShowButtons())
-                {
-                    // add new library button
-                    QFileInfo fiNewButton(mGameData->getNewLibButton());
-                    if (fiNewButton.isFile())
-                    {
-                        LibraryButton *newButton = new LibraryButton(fiNewButton.absoluteFilePath(), *mGameData, true);
-                        QPointF qpfNewLib = getButtonPosition(fiNewButton.absoluteFilePath(), iTotalCats, true);
-                        newButton->setPos(qpfNewLib);
-                        mMainScene->addItem(newButton);
-                    }
-
-                    // add reset library button
-                    QFileInfo fiResetButton(mGameData->getResetLibButton());
-                    if (fiResetButton.isFile())
-                    {
-                        LibraryButton *resetButton = new LibraryButton(fiResetButton.absoluteFilePath(), *mGameData, false);
-                        QPointF qpfResetLib = getButtonPosition(fiResetButton.absoluteFilePath(), iTotalCats, false);
-                        resetButton->setPos(qpfResetLib);
-                        mMainScene->addItem(resetButton);
-                    }
-                }
-
-                QStringList nameFilter;
-                nameFilter << "*.png" << "*.jpg";
-
-                int iImgCounter = 0, iCatCounter = 0, iTotalImgs = 0;
-
-                // load all categories first so when we add the images, we know where they are and don't overlap
-                foreach(QFileInfo fiImage, libDir.entryInfoList(nameFilter, QDir::Files))
-                {
-                    if (fiImage.isFile())
-                    {
-                        if (fiImage.fileName().mid(0,3).toUpper() == "CAT")
-                        {
-                            // new category - adds itself to the gameData structure, but we get it's position from here
-                            Category *newCat = new Category(fiImage.absoluteFilePath(), *mGameData, iCatCounter);
-                            GameData::CategoryDetails thisCat = mGameData->getCatDetails()[iCatCounter];
-                            QPointF qpfPos = getCategoryPosition(iCatCounter, iTotalCats, thisCat.qsCatSize.width(), thisCat.qsCatSize.height(), thisCat.rungWidth);
-                            newCat->setPos(qpfPos);
-                            mMainScene->addItem(newCat);
-                            mGameData->setCatPos(iCatCounter, qpfPos);
-
-                            iCatCounter++;
-                        }
-                        else
-                            iTotalImgs++;
-                    }
-                }
-
-                foreach(QFileInfo fiImage, libDir.entryInfoList(nameFilter, QDir::Files))
-                {
-                    if (fiImage.isFile())
-                    {
-                        if (fiImage.fileName().mid(0,3).toUpper() != "CAT")
-                        {
-                            // new image for categorising - adds itself to the gameData structure
-                            DragImage *newImage = new DragImage(fiImage.absoluteFilePath(), *mGameData, iImgCounter);
-                            GameData::ImageDetails thisIm = mGameData->getImageDetails()[iImgCounter];
-                            // calculate image position (depends on mode and intelligent to avoiding categories)
-                            QPointF qpfPos = getImagePosition(thisIm.qsImageSize.width(), thisIm.qsImageSize.height(), bTurnTake, iImgCounter, iTotalImgs);
-                            newImage->setPos(qpfPos);
-                            mMainScene->addItem(newImage);
-                            mGameData->setImagePositionById(iImgCounter, qpfPos);
-
-                            iImgCounter++;
-                        }
-                    }
-                }
-
-                // if we are showing 1 at a time then give it index 0
-                if (mGameData->getOneAtATime())
-                {
-                    mGameData->setShuffleOrder();
-                    mGameData->setCurrOneToShow(0);
-                }
-
-                emit libraryLoaded();
-                // now all images are in, restart the collision detection
-                mGameData->setCollisionCheck(true);
-            //}
-        }
-        else
+        for (int iImgCounter = 0; iImgCounter < iTotalImgs; iImgCounter++)
+            library.iDecodeImages.append(iImgCounter);
+    }
+
+    QList<LibraryIndex::ImageEntry> images = library.entry.categories;
+    foreach (int iImage, library.iDecodeImages)
+        images.append(library.entry.images.at(iImage));
+
+    return images;
+}
+
+// only one image is on screen at a time in one-at-a-time, so the rest can wait - turn taking always shows them all
+bool LibraryManager::getLazyDecode(bool bTurnTake)
+{
+    return mGameData->getOneAtATime() && !bTurnTake && mGameData->getDecodeAhead() >= 0;
+}
+
+// decode at the size things are shown - no bigger than the screen, plus a thumbnail the size of the library's largest ladder rung
+// rungs are a category's height split by the number of rungs, so the tallest category gives the largest
+LibraryDecoder LibraryManager::getDecoder(const LibraryIndex::LibraryEntry &entry)
+{
+    QSize qsScreen = mGameData->getScreenSize();
+    QSize qsRung;
+
+    foreach (LibraryIndex::ImageEntry category, entry.categories)
+    {
+        int iRungHeight = LibraryDecoder::getDisplaySize(category.qsSize, qsScreen).height() / mGameData->getLadderRungs();
+        if (iRungHeight > qsRung.height())
+            qsRung = QSize(mGameData->getLadderWidth(), iRungHeight);
+    }
+
+    return LibraryDecoder(qsScreen, qsRung);
+}
+
+// all images decoded - swap the new library into the scene
+void LibraryManager::libraryDecoded()
+{
+    if (mDecodeWatcher.isCanceled())
+        return;
+
+    mPending.iDecodeNs = mPending.decodeTimer.nsecsElapsed();
+    buildLibrary(mPending, mDecodeWatcher.future().results());
+}
+
+// decode the library nextLibrary() would go to while this one is played
+void LibraryManager::startPrefetch()
+{
+    if (mGameData->getPrefetchMemoryMB() <= 0)
+        return;
+
+    int iNext = miShownLibrary + 1;
+    if (iNext >= mGameData->getLibraryLimit())
+        iNext = 0;
+
+    if (iNext == miShownLibrary || mPrefetch.iLibraryId == iNext)
+        return;                                         // only one library, or already prefetched/prefetching it
+
+    if (mPrefetchWatcher.isRunning())
+    {
+        mPrefetch.iLibraryId = -1;                      // wrong guess - dropped when it finishes, which calls back here
+        return;
+    }
+
+    mPrefetchImages.clear();
+    mPrefetch.iLibraryId = -1;
+
+    PendingLibrary nextLibrary;
+    if (!scanLibrary(iNext, nextLibrary))
+        return;
+
+    // memory cap - sizes come from the index, so nothing is decoded if it won't fit
+    // images already in the cache are shared with it, so they don't count
+    QList<LibraryIndex::ImageEntry> images = selectDecodeImages(nextLibrary);
+    QSize qsScreen = mGameData->getScreenSize();
+    qint64 iBytes = 0;
+
+    foreach (LibraryIndex::ImageEntry image, images)
+    {
+        if (!ImageCache::globalInstance()->contains(image.sFile, image.qdtModified, qsScreen))
         {
-            qDebug() << "Lib folders found, but index given was wrong.";
+            QSize qsDisplay = LibraryDecoder::getDisplaySize(image.qsSize, qsScreen);
+            iBytes += qint64(qsDisplay.width()) * qsDisplay.height() * 4;
         }
     }
+
+    if (iBytes > qint64(mGameData->getPrefetchMemoryMB()) * 1024 * 1024)
+    {
+        if (mGameData->getPerformanceStats())
+            qDebug() << "Library" << nextLibrary.entry.sFolder << "not prefetched:" << iBytes / (1024 * 1024) << "MB is over the cap";
+        return;
+    }
+
+    mPrefetch = nextLibrary;
+    mPrefetch.decodeTimer.start();
+    mPrefetchWatcher.setFuture(QtConcurrent::run(getDecoder(mPrefetch.entry), &LibraryDecoder::decodeAll, images));
+}
+
+void LibraryManager::prefetchDecoded()
+{
+    if (mPrefetch.iLibraryId < 0)
+    {
+        startPrefetch();                                // the guess changed while decoding - try again
+        return;
+    }
+
+    mPrefetch.iDecodeNs = mPrefetch.decodeTimer.nsecsElapsed();
+    mPrefetchImages = mPrefetchWatcher.future().result();
+
+    if (mbAdoptPrefetch)
+    {
+        mbAdoptPrefetch = false;
+        buildPrefetchedLibrary();
+    }
 }
 
-// get the library properties from the foldername - use underscore delimiter
-QString LibraryManager::extractLibraryProps(QString sLibDirectory)
+// hand the prefetched library over to be built - the images are implicitly shared, so this is only a swap
+void LibraryManager::buildPrefetchedLibrary()
 {
-    QStringList splitString = sLibDirectory.split("_");
-    splitString.removeAt(0);        // remove lib UID from start
-    splitString.removeAt(1);        // remove lib mode
-    return splitString.join("_");   // rejoin props to be unpacked by robot
+    PendingLibrary library = mPrefetch;
+    QList<LibraryImage> decoded = mPrefetchImages;
+
+    mPrefetch.iLibraryId = -1;
+    mPrefetchImages.clear();
+
+    buildLibrary(library, decoded);
 }
 
-bool LibraryManager::extractLibraryTurnTakeMode(QString sLibDirectory)
+// create the scene items for a decoded library - GUI thread
+void LibraryManager::buildLibrary(const PendingLibrary &library, const QList<LibraryImage> &decoded)
 {
-    QStringList splitString = sLibDirectory.split("_");
-    if (splitString.at(1) == "mode0")
-        return false;
-    else
-        return true;
+    QElapsedTimer buildTimer;
+    buildTimer.start();
+
+    int iTotalCats = library.entry.categories.length();
+    int iTotalImgs = library.entry.images.length();
+
+    // for the DREAM game, we often intentionally don't want categories, so no check on there being at least 1
+
+    mGameData->setCollisionCheck(false);     // turn off collision checking - causes a crash if on whilst library changing
+    mGameData->beginBoardUpdate();           // readers keep seeing the old board until the new one is complete
+    mCategories.clear();
+    mImages.clear();
+    mMainScene->clear();                     // clear scene, also destroys objects
+
+    // the new tables are built off to the side and replace the old ones whole once every item is in
+    BoardBuilder board(mGameData->getScreenSize(), iTotalCats, iTotalImgs);
+
+    mGameData->setLibraryProperties(library.entry.sProps);
+
+    // the library name says which mode we are in
+    bool bTurnTake = library.entry.bTurnTake;
+    mGameData->setTurnTakeMode(bTurnTake);
+    if (bTurnTake)
+        mGameData->setOneAtATime(false);
+
+    if (mGameData->getShowButtons())
+    {
+        // add new library button
+        QFileInfo fiNewButton(mGameData->getNewLibButton());
+        if (fiNewButton.isFile())
+        {
+            QImage qiNewButton = ImageCache::globalInstance()->getImage(fiNewButton.absoluteFilePath(), fiNewButton.lastModified());
+            LibraryButton *newButton = new LibraryButton(qiNewButton, *mGameData, true);
+            QPointF qpfNewLib = getButtonPosition(qiNewButton.size(), iTotalCats, true);
+            newButton->setPos(qpfNewLib);
+            mMainScene->addItem(newButton);
+        }
+
+        // add reset library button
+        QFileInfo fiResetButton(mGameData->getResetLibButton());
+        if (fiResetButton.isFile())
+        {
+            QImage qiResetButton = ImageCache::globalInstance()->getImage(fiResetButton.absoluteFilePath(), fiResetButton.lastModified());
+            LibraryButton *resetButton = new LibraryButton(qiResetButton, *mGameData, false);
+            QPointF qpfResetLib = getButtonPosition(qiResetButton.size(), iTotalCats, false);
+            resetButton->setPos(qpfResetLib);
+            mMainScene->addItem(resetButton);
+        }
+    }
+
+    // load all categories first so when we add the images, we know where they are and don't overlap
+    for (int iCatCounter = 0; iCatCounter < iTotalCats; iCatCounter++)
+    {
+        // new category - adds itself to the new board, but we get it's position from here
+        Category *newCat = new Category(library.entry.categories.at(iCatCounter), decoded.at(iCatCounter).qiImage, *mGameData, board, iCatCounter);
+        QPointF qpfPos = library.layout.qpfCategoryPositions.at(iCatCounter);
+        newCat->setPos(qpfPos);
+        mMainScene->addItem(newCat);
+        mCategories.append(newCat);
+        board.setCategoryPosition(iCatCounter, qpfPos);
+    }
+
+    for (int iImgCounter = 0; iImgCounter < iTotalImgs; iImgCounter++)
+    {
+        // new image for categorising - adds itself to the new board
+        DragImage *newImage = new DragImage(library.entry.images.at(iImgCounter), library.layout.qsImageSizes.at(iImgCounter), *mGameData, board, iImgCounter);
+        QPointF qpfPos = library.layout.qpfImagePositions.at(iImgCounter);     // laid out before decoding
+        newImage->setPos(qpfPos);
+        mMainScene->addItem(newImage);
+        mImages.append(newImage);
+        board.setImagePosition(iImgCounter, qpfPos);
+    }
+
+    qint64 iItemsNs = buildTimer.nsecsElapsed();
+    mGameData->setBoard(board);
+    qint64 iSetBoardNs = buildTimer.nsecsElapsed() - iItemsNs;
+
+    // pixels for the images decoded so far - one-at-a-time gets the rest as they come up
+    for (int iDecoded = 0; iDecoded < library.iDecodeImages.length(); iDecoded++)
+    {
+        const LibraryImage &image = decoded.at(iTotalCats + iDecoded);
+        mImages.at(library.iDecodeImages.at(iDecoded))->setImage(image.qiImage, image.qiThumbnail);
+    }
+
+    // if we are showing 1 at a time then give it index 0 - in the order the images were decoded for
+    if (mGameData->getOneAtATime())
+    {
+        mGameData->setShuffleOrder(library.iShuffle);
+        mGameData->setCurrOneToShow(0);
+    }
+
+    mGameData->endBoardUpdate();     // publish the whole new library in one go
+
+    miShownLibrary = library.iLibraryId;
+    miLibraryBuilds++;
+    mShownEntry = library.entry;
+    mShownDecoder = getDecoder(library.entry);
+    miShuffle = library.iShuffle;
+    mGameData->setLibraryLoading(false);
+
+    if (mGameData->getPerformanceStats())
+    {
+        qDebug() << "Library" << library.entry.sFolder << ":" << iTotalCats + iTotalImgs << "images, scan" << library.iScanNs / 1000000.0
+                 << "ms, decode" << library.iDecodeNs / 1000000.0 << "ms on" << QThreadPool::globalInstance()->maxThreadCount()
+                 << "threads, build" << buildTimer.nsecsElapsed() / 1000000.0 << "ms";
+        qDebug() << "Library" << library.entry.sFolder << ": items and board tables for" << iTotalImgs << "images built in" << iItemsNs / 1000000.0
+                 << "ms, handed to gameData in" << iSetBoardNs / 1000000.0 << "ms";
+
+        // what the library would hold at full size, against what is kept - display sized images and their thumbnails
+        qint64 iSourceBytes = 0, iResidentBytes = 0;
+        foreach (LibraryIndex::ImageEntry image, library.entry.categories + library.entry.images)
+            iSourceBytes += qint64(image.qsSize.width()) * image.qsSize.height() * 4;
+        foreach (LibraryImage image, decoded)
+            iResidentBytes += image.qiImage.byteCount() + image.qiThumbnail.byteCount();
+
+        qDebug() << "Library" << library.entry.sFolder << ":" << library.iDecodeImages.length() << "of" << iTotalImgs << "images decoded before the first was shown";
+        qDebug() << "Library" << library.entry.sFolder << "image memory:" << iSourceBytes / 1024 << "KB at full size," << iResidentBytes / 1024 << "KB at display size with thumbnails";
+        qDebug() << "Prefetch hits" << miPrefetchHits << "of" << miPrefetchHits + miPrefetchMisses << "library changes";
+        qDebug() << ImageCache::globalInstance()->getSummary();
+        qDebug() << "Library folders read since start up:" << mIndex.getLibrariesScanned() << "of" << mIndex.getLibraryCount();
+    }
+
+    emit libraryLoaded();
+    // now all images are in, restart the collision detection
+    mGameData->setCollisionCheck(true);
+
+    decodeAhead();
+    startPrefetch();
 }
 
-// loops through the library path and counts the number of categories are present (file must start 'cat...')
-int LibraryManager::getNumberOfCategoriesInLibrary(QDir libDir)
+// keep the image shown, and the next few in the shuffle, decoded - called each time one-at-a-time moves on
+// images seated in a ladder rung are drawn from their thumbnails, so their full pixels are let go - dropImage keeps any that aren't
+// outside one-at-a-time this decodes anything still missing, e.g. the mode changed after a library was decoded lazily
+void LibraryManager::decodeAhead()
 {
-    int iNum = 0;
+    if (mAheadWatcher.isRunning())
+    {
+        mbAheadPending = true;
+        return;
+    }
+
+    QList<int> iWanted;
+
+    if (getLazyDecode(mShownEntry.bTurnTake))
+    {
+        int iCurrent = miShuffle.indexOf(mGameData->getCurrOneToShow());
+
+        if (iCurrent >= 0)
+        {
+            for (int iNext = iCurrent; iNext < miShuffle.length() && iNext <= iCurrent + mGameData->getDecodeAhead(); iNext++)
+                iWanted.append(miShuffle.at(iNext));
+        }
+
+        const GameData::ImageHotState hotImages = mGameData->getImageHotState();
+        for (int iImage = 0; iImage < hotImages.bActive.size() && iImage < mImages.length(); iImage++)
+        {
+            if (!hotImages.bActive.at(iImage) && !iWanted.contains(iImage))
+                mImages.at(iImage)->dropImage();
+        }
+    }
+    else
+    {
+        for (int iImage = 0; iImage < mImages.length(); iImage++)
+            iWanted.append(iImage);
+    }
 
-    QStringList nameFilter;
-    nameFilter << "*.png" << "*.jpg";
+    QList<LibraryIndex::ImageEntry> images;
+    miAheadImages.clear();
 
-    foreach(QFileInfo fiImage, libDir.entryInfoList(nameFilter, QDir::Files))
+    foreach (int iImage, iWanted)
     {
-        if (fiImage.isFile())
+        if (iImage < mImages.length() && iImage < mShownEntry.images.length() && !mImages.at(iImage)->hasImage())
         {
-            if (fiImage.fileName().mid(0,3).toUpper() == "CAT")
-            {
-                iNum++;
-            }
+            miAheadImages.append(iImage);
+            images.append(mShownEntry.images.at(iImage));
         }
     }
 
-    return iNum;
+    if (images.isEmpty())
+        return;
+
+    miAheadBuild = miLibraryBuilds;
+    mAheadWatcher.setFuture(QtConcurrent::mapped(images, mShownDecoder));
+}
+
+void LibraryManager::aheadDecoded()
+{
+    // a library built since has new items, which get their own decode
+    if (miAheadBuild == miLibraryBuilds)
+    {
+        QList<LibraryImage> decoded = mAheadWatcher.future().results();
+
+        for (int iDecoded = 0; iDecoded < decoded.length() && iDecoded < miAheadImages.length(); iDecoded++)
+            mImages.at(miAheadImages.at(iDecoded))->setImage(decoded.at(iDecoded).qiImage, decoded.at(iDecoded).qiThumbnail);
+    }
+
+    if (mbAheadPending || miAheadBuild != miLibraryBuilds)
+    {
+        mbAheadPending = false;
+        decodeAhead();
+    }
+}
+
+// redraw only the items whose state changed - ids from before a library change are ignored if out of range
+void LibraryManager::updateImage(int iImageId)
+{
+    if (iImageId >= 0 && iImageId < mImages.length())
+        mImages.at(iImageId)->update();
+}
+void LibraryManager::updateCategory(int iCatNo)
+{
+    if (iCatNo >= 0 && iCatNo < mCategories.length())
+        mCategories.at(iCatNo)->update();
+}
+
+// a change that affects how every item is drawn, e.g. one-at-a-time moving on
+void LibraryManager::updateScene()
+{
+    mMainScene->update();
+}
+
+// called every frame while animating - redraw the categories fading feedback and the images the robot is moving
+void LibraryManager::updateAnimatedItems()
+{
+    const QList<GameData::CategoryDetails> categories = mGameData->getCatDetails();
+    const GameData::ImageHotState hotImages = mGameData->getImageHotState();
+
+    for (int iCat = 0; iCat < categories.length() && iCat < mCategories.length(); iCat++)
+    {
+        if (categories.at(iCat).bShowFeedback)
+            mCategories.at(iCat)->update();
+    }
+
+    for (int iImage = 0; iImage < hotImages.bRobotMoving.size() && iImage < mImages.length(); iImage++)
+    {
+        if (hotImages.bRobotMoving.at(iImage))
+            mImages.at(iImage)->update();
+    }
 }
 
 // return X and Y position for a category based on how many total and which one this is; implemented for 1, 2 or 4 cats
@@ -265,74 +691,57 @@ QPointF LibraryManager::getCategoryPosition(int iThisCat, int iTotalCats, int iI
 }
 
 // pick a random position within the screen bounds taking into account the image size
-// see if it overlaps with any category image - loop again if it does
-QPointF LibraryManager::getImagePosition(int imWidth, int imHeight, bool bTurnTake, int iImgPos, int iTotalImgs)
+// the placement engine only offers positions clear of the categories, and of other images if there is a spacing - so no retry loop
+// pbFree is set false if the board was too full, and the image went where it overlaps least
+QPointF LibraryManager::getImagePosition(int imWidth, int imHeight, bool bTurnTake, bool bCentre, int iImgPos, int iTotalImgs, int iSpacing, PlacementEngine &placement, bool *pbFree)
 {
     int iScreenWidth = mGameData->getScreenSize().width();
-    int iScreenHeight = mGameData->getScreenSize().height();
     int iScreenL = - iScreenWidth / 2;
-    int iScreenR = iScreenWidth / 2;
-    int iScreenT = - iScreenHeight / 2;
-    int iScreenB = iScreenHeight / 2;
-    int iXPos, iYPos;
-    bool bGoodPosition = false;
+    QPointF qpfPos;
+
+    if (pbFree)
+        *pbFree = true;
 
     if (bTurnTake)
     {
        // we know for turn taking that we have images to go across the centre of the screen
        int iInterval = iScreenWidth / (3*(iTotalImgs)-1); // split screen into equal chunks
-       iXPos = iScreenL + (iInterval * (3*iImgPos + 1));  // horizontal position determined by ID
-       iYPos = 0;                                       // centre vertically
+       qpfPos = QPointF(iScreenL + (iInterval * (3*iImgPos + 1)), 0);  // horizontal position determined by ID, centre vertically
+    }
+    // centre images if we are showing one-at-a-time and the option is on, otherwise random placement
+    else if (bCentre)
+    {
+        qpfPos = QPointF(0, 0);
     }
     else
     {
-        while(!bGoodPosition)
-        {
-            // centre images if we are showing one-at-a-time and the option is on, otherwise random placement
-            if (mGameData->getCentreImages() && mGameData->getOneAtATime() && (mGameData->getNumberOfCats() != 1))
-            {
-                iXPos = 0;
-                iYPos = 0;
-            }
-            else
-            {
-                iXPos = getRandomNumber(iScreenL + (imWidth / 2), iScreenR - (imWidth / 2));
-                iYPos = getRandomNumber(iScreenT + (imHeight / 2), iScreenB - (imHeight / 2));
-            }
-
-            int imageL = iXPos - (imWidth / 2);
-            int imageR = iXPos + (imWidth / 2);
-            int imageT = iYPos - (imHeight / 2);
-            int imageB = iYPos + (imHeight / 2);
-            bool bCollision = false;
-
-            QList<GameData::CategoryDetails> allCats = mGameData->getCatDetails();
-
-            foreach (GameData::CategoryDetails thisCat, allCats)
-            {
-                int iCatL = thisCat.qpfCatPosition.x() - (thisCat.qsCatSize.width() / 2);
-                int iCatR = thisCat.qpfCatPosition.x() + (thisCat.qsCatSize.width() / 2);
-                int iCatT = thisCat.qpfCatPosition.y() - (thisCat.qsCatSize.height() / 2);
-                int iCatB = thisCat.qpfCatPosition.y() + (thisCat.qsCatSize.height() / 2);
-
-                if (imageL < iCatR && imageR > iCatL && imageT < iCatB && imageB > iCatT)
-                {
-                    bCollision = true;
-                    break;
-                }
-            }
-
-            // if we have no collision then we are happy, so stop this loop
-            if (!bCollision)
-                bGoodPosition = true;
-        }
+        qpfPos = placement.findSpace(QSize(imWidth, imHeight), pbFree);
     }
 
-    return QPointF(iXPos, iYPos);
+    // later images keep clear of this one
+    if (iSpacing >= 0)
+        placement.block(SpatialGrid::boundsAround(qpfPos, QSize(imWidth, imHeight), iSpacing));
+
+    return qpfPos;
+}
+
+// images are centred if we are showing one-at-a-time and the option is on - unless there's a single category
+bool LibraryManager::getCentreImages(bool bOneAtATime, int iTotalCats)
+{
+    return mGameData->getCentreImages() && bOneAtATime && (iTotalCats != 1);
+}
+
+// free space on the board, for placing images around - covers the screen, the scene origin at its centre
+PlacementEngine LibraryManager::createPlacementEngine()
+{
+    QSize qsScreen = mGameData->getScreenSize();
+    PlacementEngine placement;
+    placement.setBounds(QRect(-qsScreen.width() / 2, -qsScreen.height() / 2, qsScreen.width(), qsScreen.height()));
+    return placement;
 }
 
 // return the position for the new and reset buttons based on the number of categories
-QPointF LibraryManager::getButtonPosition(QString sFilePath, int iTotalCats, bool bNewLibrary)
+QPointF LibraryManager::getButtonPosition(QSize qsButton, int iTotalCats, bool bNewLibrary)
 {
     int iScreenWidth = mGameData->getScreenSize().width();
     int iScreenHeight = mGameData->getScreenSize().height();
@@ -341,10 +750,8 @@ QPointF LibraryManager::getButtonPosition(QString sFilePath, int iTotalCats, boo
     int iScreenB = iScreenHeight / 2;
     int iXPos, iYPos;
 
-    QImage qiImage;
-    qiImage.load(sFilePath);
-    int iImageH = qiImage.height();
-    int iImageW = qiImage.width();
+    int iImageH = qsButton.height();
+    int iImageW = qsButton.width();
 
     if (bNewLibrary)
         iYPos = iScreenB - (iImageH / 2);       // bottom of screen
@@ -358,8 +765,3 @@ QPointF LibraryManager::getButtonPosition(QString sFilePath, int iTotalCats, boo
 
     return QPointF(iXPos, iYPos);
 }
-
-int LibraryManager::getRandomNumber(int min, int max)
-{
-   return (qrand() % ((max + 1) - min)) + min;
-}
@@ -3,10 +3,18 @@
 
 #include <QtGui>
 #include <QObject>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 
 #include "dragimage.h"
 #include "category.h"
 #include "librarybutton.h"
+#include "imagecache.h"
+#include "libraryindex.h"
+#include "libraryarchive.h"
+#include "librarydecoder.h"
+#include "boardbuilder.h"
+#include "placementengine.h"
 
 class LibraryManager : public QObject
 {
@@ -18,25 +26,84 @@ public:
 
 signals:
     void libraryLoaded();
+    void libraryLaidOut();          // the board layout is in gameData - the items follow once decoded
+    void libraryFailed();           // the library asked for can't be loaded - nothing else follows, the old one stays
 
 public slots:
     void nextLibrary();
     void reloadCurrentLibrary();
+    void updateImage(int iImageId);
+    void updateCategory(int iCatNo);
+    void updateScene();
+    void updateAnimatedItems();
+    void decodeAhead();
+
+private slots:
+    void libraryDecoded();
+    void prefetchDecoded();
+    void aheadDecoded();
 
 private:
+    struct PendingLibrary;
+
     void loadLibrary();
-    QString extractLibraryProps(QString sLibDirectory);
-    bool extractLibraryTurnTakeMode(QString sLibDirectory);
-    int getNumberOfCategoriesInLibrary(QDir libDir);
+    void resetLibrary();
+    bool scanLibrary(int iLibraryId, PendingLibrary &library);
+    void layoutLibrary(PendingLibrary &library);
+    QList<LibraryIndex::ImageEntry> selectDecodeImages(PendingLibrary &library);
+    bool getLazyDecode(bool bTurnTake);
+    void buildLibrary(const PendingLibrary &library, const QList<LibraryImage> &decoded);
+    void startPrefetch();
+    void buildPrefetchedLibrary();
+    LibraryDecoder getDecoder(const LibraryIndex::LibraryEntry &entry);
     QPointF getCategoryPosition(int iThisCat, int iTotalCats, int iImWidth, int iImHeight, int iLadderWidth);
-    QPointF getImagePosition(int imWidth, int imHeight, bool bTurnTake, int iImgPos, int iTotalImgs);
-    QPointF getButtonPosition(QString sFilePath, int iTotalCats, bool bNewLibrary);
-    int getRandomNumber(int min, int max);
+    QPointF getImagePosition(int imWidth, int imHeight, bool bTurnTake, bool bCentre, int iImgPos, int iTotalImgs, int iSpacing, PlacementEngine &placement, bool *pbFree = 0);
+    bool getCentreImages(bool bOneAtATime, int iTotalCats);
+    PlacementEngine createPlacementEngine();
+    QPointF getButtonPosition(QSize qsButton, int iTotalCats, bool bNewLibrary);
 
     QGraphicsScene* mMainScene;
     GameData* mGameData;
 
     QString msLibRoot;
+    LibraryIndex mIndex;            // names, properties and sizes of every library - read from disk once, kept up to date as folders change
+    QList<Category*> mCategories;   // items in the scene, by id - so changes in gameData only redraw the items affected
+    QList<DragImage*> mImages;
+
+    // library being decoded - scanned on the GUI thread, decoded on the pool, then built back on the GUI thread
+    struct PendingLibrary
+    {
+        int iLibraryId;
+        LibraryIndex::LibraryEntry entry;   // decoded images come back in the order of its categories, then images
+        GameData::BoardLayout layout;
+        QList<int> iShuffle;                // one-at-a-time order, picked before decoding so the first shown are decoded first
+        QList<int> iDecodeImages;           // images decoded before it is built, in the order they come back after the categories
+        qint64 iScanNs;
+        qint64 iDecodeNs;
+        QElapsedTimer decodeTimer;
+    };
+    PendingLibrary mPending;
+    QFutureWatcher<LibraryImage> mDecodeWatcher;
+
+    int miShownLibrary;             // library in the scene now
+    int miLibraryBuilds;            // bumped every build, so late decodes for items that have gone are ignored
+
+    // one-at-a-time decodes along the shuffle as images are shown, rather than the whole library up front
+    LibraryIndex::LibraryEntry mShownEntry;
+    LibraryDecoder mShownDecoder;
+    QList<int> miShuffle;
+    QList<int> miAheadImages;       // image ids being decoded, in the order they come back
+    int miAheadBuild;
+    bool mbAheadPending;            // asked again while decoding - looked at once it finishes
+    QFutureWatcher<LibraryImage> mAheadWatcher;
+
+    // the library after the one shown, decoded in the background so a new game is only a swap
+    PendingLibrary mPrefetch;       // iLibraryId is -1 when nothing useful is prefetched
+    QList<LibraryImage> mPrefetchImages;
+    QFutureWatcher<QList<LibraryImage> > mPrefetchWatcher;
+    bool mbAdoptPrefetch;           // the library asked for is still prefetching - build it when it's done
+    int miPrefetchHits;
+    int miPrefetchMisses;
 };
 
 #endif // LIBRARY_MANAGER_H
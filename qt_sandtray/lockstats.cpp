@@ -0,0 +1,155 @@
+#include "lockstats.h"
+
+LockStats::LockStats()
+{
+    mbEnabled = false;
+}
+
+void LockStats::setEnabled(bool bEnabled)
+{
+    mbEnabled = bEnabled;
+}
+bool LockStats::isEnabled() const
+{
+    return mbEnabled;
+}
+
+void LockStats::record(const char* sSite, qint64 iWaitNs, qint64 iHoldNs)
+{
+    Qt::HANDLE hThread = QThread::currentThreadId();
+
+    QMutexLocker locker(&mutex);
+
+    addTo(mSites[sSite], iWaitNs, iHoldNs);
+    addTo(mThreads[hThread], iWaitNs, iHoldNs);
+
+    if (!mThreadNames.contains(hThread))
+    {
+        QString sName = QThread::currentThread()->objectName();
+
+        if (sName.isEmpty())
+            sName = "thread 0x" + QString::number(quintptr(hThread), 16);
+
+        mThreadNames.insert(hThread, sName);
+    }
+}
+
+void LockStats::reset()
+{
+    QMutexLocker locker(&mutex);
+    mSites.clear();
+    mThreads.clear();
+}
+
+// one line per call site (most waited on first), then one per thread
+QStringList LockStats::getReport()
+{
+    QMutexLocker locker(&mutex);
+    QStringList slReport;
+
+    slReport.append("Lock statistics - acquisitions, total/max wait, total/max hold in us");
+
+    foreach (const char* sSite, getSitesByWait())
+        slReport.append("  " + formatCounters(shortSiteName(sSite), mSites.value(sSite)));
+
+    QHash<Qt::HANDLE, Counters>::const_iterator it;
+    for (it = mThreads.constBegin(); it != mThreads.constEnd(); ++it)
+        slReport.append("  [" + formatCounters(mThreadNames.value(it.key()), it.value()) + "]");
+
+    return slReport;
+}
+
+// compact form for the server: site:count:wait:maxwait:hold:maxhold for the most waited on sites
+QString LockStats::getSummary(int iMaxSites)
+{
+    QMutexLocker locker(&mutex);
+    QStringList slSites;
+
+    foreach (const char* sSite, getSitesByWait())
+    {
+        if (slSites.length() >= iMaxSites)
+            break;
+
+        const Counters counters = mSites.value(sSite);
+        slSites.append(shortSiteName(sSite) + ":" + QString::number(counters.iAcquisitions) + ":" +
+                       QString::number(counters.iTotalWaitNs / 1000) + ":" + QString::number(counters.iMaxWaitNs / 1000) + ":" +
+                       QString::number(counters.iTotalHoldNs / 1000) + ":" + QString::number(counters.iMaxHoldNs / 1000));
+    }
+
+    return slSites.join(",");
+}
+
+void LockStats::addTo(Counters &counters, qint64 iWaitNs, qint64 iHoldNs)
+{
+    counters.iAcquisitions++;
+    counters.iTotalWaitNs += iWaitNs;
+    counters.iMaxWaitNs = qMax(counters.iMaxWaitNs, iWaitNs);
+    counters.iTotalHoldNs += iHoldNs;
+    counters.iMaxHoldNs = qMax(counters.iMaxHoldNs, iHoldNs);
+}
+
+QString LockStats::formatCounters(QString sName, const Counters &counters)
+{
+    return sName + " " + QString::number(counters.iAcquisitions) + " " +
+           QString::number(counters.iTotalWaitNs / 1000) + "/" + QString::number(counters.iMaxWaitNs / 1000) + " " +
+           QString::number(counters.iTotalHoldNs / 1000) + "/" + QString::number(counters.iMaxHoldNs / 1000);
+}
+
+// "bool GameData::getRobotLocked()" -> "GameData::getRobotLocked" - also keeps commas out of the server reply
+QString LockStats::shortSiteName(const char* sSite)
+{
+    QString sName = QString::fromLatin1(sSite);
+    sName = sName.left(sName.indexOf('('));
+    return sName.mid(sName.lastIndexOf(' ') + 1);
+}
+
+// called with the mutex held
+QList<const char*> LockStats::getSitesByWait() const
+{
+    QMultiMap<qint64, const char*> sitesByWait;
+
+    QHash<const char*, Counters>::const_iterator it;
+    for (it = mSites.constBegin(); it != mSites.constEnd(); ++it)
+        sitesByWait.insert(-it.value().iTotalWaitNs, it.key());
+
+    return sitesByWait.values();
+}
+
+// instrumented locker ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+InstrumentedLocker::InstrumentedLocker(QMutex* pMutex, LockStats* pStats, const char* sSite)
+{
+    mpMutex = pMutex;
+    mpStats = pStats->isEnabled() ? pStats : 0;
+    msSite = sSite;
+    miWaitNs = 0;
+
+    if (mpStats)
+    {
+        mTimer.start();
+        mpMutex->lock();
+        miWaitNs = mTimer.nsecsElapsed();
+        mTimer.restart();
+    }
+    else
+        mpMutex->lock();
+
+    mbLocked = true;
+}
+InstrumentedLocker::~InstrumentedLocker()
+{
+    unlock();
+}
+
+void InstrumentedLocker::unlock()
+{
+    if (!mbLocked)
+        return;
+
+    qint64 iHoldNs = mpStats ? mTimer.nsecsElapsed() : 0;
+    mpMutex->unlock();
+    mbLocked = false;
+
+    // recorded after the unlock so the bookkeeping doesn't add to the hold time of the next waiter
+    if (mpStats)
+        mpStats->record(msSite, iWaitNs, iHoldNs);
+}
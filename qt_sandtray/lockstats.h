@@ -0,0 +1,62 @@
+#ifndef LOCKSTATS_H
+#define LOCKSTATS_H
+
+#include <QtCore>
+
+// acquisition count, wait and hold times for one mutex, broken down per call site and per thread
+// recording is off unless enabled at start up, and then every lock costs two timer reads and a short locked update
+class LockStats
+{
+public:
+    LockStats();
+
+    void setEnabled(bool bEnabled);
+    bool isEnabled() const;
+
+    void record(const char* sSite, qint64 iWaitNs, qint64 iHoldNs);
+    void reset();
+
+    QStringList getReport();
+    QString getSummary(int iMaxSites);
+
+private:
+    struct Counters
+    {
+        qint64 iAcquisitions;
+        qint64 iTotalWaitNs;
+        qint64 iMaxWaitNs;
+        qint64 iTotalHoldNs;
+        qint64 iMaxHoldNs;
+    };
+
+    static void addTo(Counters &counters, qint64 iWaitNs, qint64 iHoldNs);
+    static QString formatCounters(QString sName, const Counters &counters);
+    static QString shortSiteName(const char* sSite);
+    QList<const char*> getSitesByWait() const;
+
+    QMutex mutex;                               // protects the tables - never held while the instrumented mutex is waited on
+    bool mbEnabled;
+    QHash<const char*, Counters> mSites;        // keyed on Q_FUNC_INFO of the caller, which is a string literal per function
+    QHash<Qt::HANDLE, Counters> mThreads;
+    QHash<Qt::HANDLE, QString> mThreadNames;    // object name of each thread when first seen
+};
+
+// drop in for QMutexLocker that times the wait for the lock and how long it is held
+class InstrumentedLocker
+{
+public:
+    InstrumentedLocker(QMutex* pMutex, LockStats* pStats, const char* sSite);
+    ~InstrumentedLocker();
+
+    void unlock();
+
+private:
+    QMutex* mpMutex;
+    LockStats* mpStats;
+    const char* msSite;
+    bool mbLocked;
+    qint64 miWaitNs;
+    QElapsedTimer mTimer;
+};
+
+#endif // LOCKSTATS_H
@@ -2,15 +2,30 @@
 #include <QKeyEvent>
 
 #include "gameengine.h"
+#include "libraryarchive.h"
 
 class GraphicsView : public QGraphicsView
 {
 public:
-    GraphicsView(QGraphicsScene *scene) : QGraphicsView(scene)
+    GraphicsView(QGraphicsScene *scene, GameData *gameData) : QGraphicsView(scene)
     {
+        mGameData = gameData;
+        mbPerformanceStats = mGameData->getPerformanceStats();
+        miFrames = 0;
+        miPaintedPixels = 0;
     }
 
 protected:
+    // take one snapshot of the game for the whole frame, so the items can paint without locking
+    void paintEvent(QPaintEvent *event)
+    {
+        mGameData->captureRenderState();
+        QGraphicsView::paintEvent(event);
+
+        if (mbPerformanceStats)
+            countPaintedPixels(event->region());
+    }
+
     // event handler to catch keypresses in the graphicsview and quit the app
     void keyPressEvent(QKeyEvent *keyevent)
     {
@@ -19,10 +34,56 @@ protected:
             qApp->quit();
         }
     }
+
+private:
+    // how much of the screen each frame actually repaints - logged every 100 frames
+    void countPaintedPixels(const QRegion &region)
+    {
+        foreach (QRect rPainted, region.rects())
+            miPaintedPixels += qint64(rPainted.width()) * rPainted.height();
+
+        if (++miFrames == 100)
+        {
+            qint64 iScreenPixels = qint64(viewport()->width()) * viewport()->height();
+            qint64 iMeanPixels = miPaintedPixels / miFrames;
+            qDebug() << "Painted per frame:" << iMeanPixels << "pixels," << (100.0 * iMeanPixels) / qMax(iScreenPixels, qint64(1)) << "% of the screen";
+            miFrames = 0;
+            miPaintedPixels = 0;
+        }
+    }
+
+    GameData* mGameData;
+    bool mbPerformanceStats;
+    int miFrames;
+    qint64 miPaintedPixels;
 };
 
+// offline packer - qt_sandtray --pack <library folder> [--compress] writes <library folder>.pack beside the folder
+// run without a window, so it works on the machine the libraries are built on
+int packLibrary(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList slArgs = app.arguments();
+    int iPack = slArgs.indexOf("--pack");
+
+    if (iPack + 1 >= slArgs.count())
+    {
+        qDebug() << "Usage: qt_sandtray --pack <library folder> [--compress]";
+        return 1;
+    }
+
+    QString sFolder = QDir::cleanPath(slArgs.at(iPack + 1));
+    return LibraryArchive::pack(sFolder, sFolder + ".pack", slArgs.contains("--compress")) ? 0 : 1;
+}
+
 int main(int argc, char **argv)
 {
+    for (int iArg = 1; iArg < argc; iArg++)
+    {
+        if (qstrcmp(argv[iArg], "--pack") == 0)
+            return packLibrary(argc, argv);
+    }
+
     try
     {
         QApplication app(argc, argv);
@@ -50,9 +111,9 @@ int main(int argc, char **argv)
         game.createScene();
 
         // send the graphics view to the window and display it
-        GraphicsView view(&scene);
+        GraphicsView view(&scene, game.getGameData());
         view.setRenderHint(QPainter::Antialiasing);                     // nice and sharp for our lines
-        view.setViewportUpdateMode(QGraphicsView::FullViewportUpdate);  // must be this to redraw our collisions properly
+        view.setViewportUpdateMode(QGraphicsView::MinimalViewportUpdate);  // items invalidate themselves when their state changes
         view.setBackgroundBrush(QColor(255, 255, 255));                 // white background for now
         view.setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);      // prevent scrollbars showing - needed for Win8.1
         view.setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);        // as above
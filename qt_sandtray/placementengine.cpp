@@ -0,0 +1,139 @@
+#include "placementengine.h"
+
+PlacementEngine::PlacementEngine()
+{
+    miCellSize = _PLACEMENT_CELL_SIZE_;
+    miColumns = 0;
+    miRows = 0;
+    mbSumsValid = false;
+}
+
+// size the grid to cover the area items go in - anything blocked before is cleared
+void PlacementEngine::setBounds(QRect rBounds, int iCellSize)
+{
+    mrBounds = rBounds;
+    miCellSize = qMax(iCellSize, 1);
+    miColumns = qMax((rBounds.width() + miCellSize - 1) / miCellSize, 1);
+    miRows = qMax((rBounds.height() + miCellSize - 1) / miCellSize, 1);
+
+    clear();
+}
+
+void PlacementEngine::clear()
+{
+    mOccupied.fill(false, miColumns * miRows);
+    mbSumsValid = false;
+}
+
+// mark an area as taken - every cell it touches is, so items are kept at least as far apart as asked
+void PlacementEngine::block(QRect rArea)
+{
+    QRect rClipped = rArea.intersected(mrBounds);
+    if (rClipped.isEmpty())
+        return;
+
+    int iFirstCol = (rClipped.left() - mrBounds.left()) / miCellSize;
+    int iLastCol = qMin((rClipped.right() - mrBounds.left()) / miCellSize, miColumns - 1);
+    int iFirstRow = (rClipped.top() - mrBounds.top()) / miCellSize;
+    int iLastRow = qMin((rClipped.bottom() - mrBounds.top()) / miCellSize, miRows - 1);
+
+    for (int iRow = iFirstRow; iRow <= iLastRow; iRow++)
+    {
+        for (int iCol = iFirstCol; iCol <= iLastCol; iCol++)
+            mOccupied[iRow * miColumns + iCol] = true;
+    }
+
+    mbSumsValid = false;
+}
+
+// centre of a random position where the item touches nothing blocked, picked evenly from every such position
+// if there is none, the position it overlaps least is used and pbFree is set false - so this never loops or fails
+QPointF PlacementEngine::findSpace(QSize qsItem, bool *pbFree)
+{
+    updateSums();
+
+    // the item can start anywhere inside its first cell, so it can reach one cell further than its size
+    int iItemCols = (qsItem.width() + (2 * miCellSize) - 2) / miCellSize;
+    int iItemRows = (qsItem.height() + (2 * miCellSize) - 2) / miCellSize;
+
+    QVector<int> iFreeCells;
+    int iLeastOccupied = -1;
+    int iLeastCell = -1;
+
+    for (int iRow = 0; iRow + iItemRows <= miRows; iRow++)
+    {
+        if ((iRow * miCellSize) + qsItem.height() > mrBounds.height())
+            break;                                              // no room below - the last row of cells can be partial
+
+        for (int iCol = 0; iCol + iItemCols <= miColumns; iCol++)
+        {
+            if ((iCol * miCellSize) + qsItem.width() > mrBounds.width())
+                break;
+
+            int iOccupied = getOccupiedCells(iCol, iRow, iItemCols, iItemRows);
+
+            if (iOccupied == 0)
+                iFreeCells.append(iRow * miColumns + iCol);
+            else if (iLeastOccupied < 0 || iOccupied < iLeastOccupied)
+            {
+                iLeastOccupied = iOccupied;
+                iLeastCell = iRow * miColumns + iCol;
+            }
+        }
+    }
+
+    bool bFree = !iFreeCells.isEmpty();
+    if (pbFree)
+        *pbFree = bFree;
+
+    int iCell = bFree ? iFreeCells.at(qrand() % iFreeCells.size()) : iLeastCell;
+
+    // bigger than the area - nowhere is better than anywhere else
+    if (iCell < 0)
+        return QPointF(mrBounds.center());
+
+    int iCol = iCell % miColumns;
+    int iRow = iCell / miColumns;
+
+    // somewhere inside the cell, so positions aren't all on the grid - still inside the window that was checked and the bounds
+    int iMaxXOffset = qMin(qMin(miCellSize - 1, (iItemCols * miCellSize) - qsItem.width()), mrBounds.width() - (iCol * miCellSize) - qsItem.width());
+    int iMaxYOffset = qMin(qMin(miCellSize - 1, (iItemRows * miCellSize) - qsItem.height()), mrBounds.height() - (iRow * miCellSize) - qsItem.height());
+    int iXPos = mrBounds.left() + (iCol * miCellSize) + (qrand() % (iMaxXOffset + 1));
+    int iYPos = mrBounds.top() + (iRow * miCellSize) + (qrand() % (iMaxYOffset + 1));
+
+    return QPointF(iXPos + (qsItem.width() / 2), iYPos + (qsItem.height() / 2));
+}
+
+// rebuilt by the first search after something was blocked, not by every block
+void PlacementEngine::updateSums()
+{
+    if (mbSumsValid)
+        return;
+
+    int iStride = miColumns + 1;
+    mSums.fill(0, iStride * (miRows + 1));
+
+    for (int iRow = 0; iRow < miRows; iRow++)
+    {
+        int iRowSum = 0;
+
+        for (int iCol = 0; iCol < miColumns; iCol++)
+        {
+            if (mOccupied.at(iRow * miColumns + iCol))
+                iRowSum++;
+
+            mSums[(iRow + 1) * iStride + iCol + 1] = mSums.at(iRow * iStride + iCol + 1) + iRowSum;
+        }
+    }
+
+    mbSumsValid = true;
+}
+
+// blocked cells in the window with top left (iCol, iRow)
+int PlacementEngine::getOccupiedCells(int iCol, int iRow, int iCols, int iRows) const
+{
+    int iStride = miColumns + 1;
+
+    return mSums.at((iRow + iRows) * iStride + iCol + iCols) - mSums.at(iRow * iStride + iCol + iCols)
+         - mSums.at((iRow + iRows) * iStride + iCol) + mSums.at(iRow * iStride + iCol);
+}
@@ -0,0 +1,34 @@
+#ifndef PLACEMENTENGINE_H
+#define PLACEMENTENGINE_H
+
+#include <QtGui>
+
+const int _PLACEMENT_CELL_SIZE_ = 16;               // size of an occupancy cell in pixels - positions are found to this resolution
+
+// finds a random free position for an item, from an occupancy grid of what is already on the board
+// every free position is found in one pass over the grid, so a search always ends - even on a board with no space left
+class PlacementEngine
+{
+public:
+    PlacementEngine();
+
+    void setBounds(QRect rBounds, int iCellSize = _PLACEMENT_CELL_SIZE_);
+    void clear();
+
+    void block(QRect rArea);
+    QPointF findSpace(QSize qsItem, bool *pbFree = 0);
+
+private:
+    void updateSums();
+    int getOccupiedCells(int iCol, int iRow, int iCols, int iRows) const;
+
+    QRect mrBounds;                 // area items are placed in
+    int miCellSize;
+    int miColumns;
+    int miRows;
+    QVector<bool> mOccupied;        // cells anything blocked touches - row major
+    QVector<int> mSums;             // summed area table of mOccupied, so any window is counted in four reads
+    bool mbSumsValid;
+};
+
+#endif // PLACEMENTENGINE_H
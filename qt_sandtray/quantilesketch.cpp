@@ -0,0 +1,92 @@
+#include "quantilesketch.h"
+
+QuantileSketch::QuantileSketch()
+{
+    mdLogGrowth = qLn(1.0 + (2.0 * _SKETCH_PRECISION_));
+    miCounts.resize(_SKETCH_BUCKETS_);
+    clear();
+}
+
+void QuantileSketch::add(float flValue)
+{
+    if (flValue < 0)
+        flValue = 0;
+
+    miCounts[getBucket(flValue)]++;
+
+    if (miCount == 0)
+    {
+        mflMin = flValue;
+        mflMax = flValue;
+    }
+    else
+    {
+        mflMin = qMin(mflMin, flValue);
+        mflMax = qMax(mflMax, flValue);
+    }
+
+    miCount++;
+}
+
+void QuantileSketch::clear()
+{
+    miCounts.fill(0);
+    miCount = 0;
+    mflMin = 0;
+    mflMax = 0;
+}
+
+int QuantileSketch::getCount() const
+{
+    return miCount;
+}
+
+// value below which the given fraction (0..1) of the series falls - 0 if nothing has been added
+float QuantileSketch::getQuantile(float flQuantile) const
+{
+    if (miCount == 0)
+        return 0;
+
+    // rank of the wanted value, counting from 1
+    int iRank = qBound(1, int(qCeil(qBound(0.0f, flQuantile, 1.0f) * miCount)), miCount);
+    int iSeen = 0;
+
+    for (int iBucket = 0; iBucket < miCounts.size(); iBucket++)
+    {
+        iSeen += miCounts.at(iBucket);
+
+        if (iSeen >= iRank)
+            return qBound(mflMin, getBucketValue(iBucket), mflMax);
+    }
+
+    return mflMax;
+}
+
+QList<float> QuantileSketch::getQuantiles(QList<float> flListQuantiles) const
+{
+    QList<float> flReturn;
+
+    foreach (float flQuantile, flListQuantiles)
+        flReturn.append(getQuantile(flQuantile));
+
+    return flReturn;
+}
+
+// bucket i holds (min * g^(i-1), min * g^i] - bucket 0 holds everything up to the minimum value
+int QuantileSketch::getBucket(float flValue) const
+{
+    if (flValue <= _SKETCH_MIN_VALUE_)
+        return 0;
+
+    int iBucket = int(qCeil(qLn(flValue / _SKETCH_MIN_VALUE_) / mdLogGrowth));
+    return qBound(0, iBucket, _SKETCH_BUCKETS_ - 1);
+}
+
+// middle of a bucket, so the estimate is within the precision of any value in it
+float QuantileSketch::getBucketValue(int iBucket) const
+{
+    if (iBucket == 0)
+        return _SKETCH_MIN_VALUE_;
+
+    return float(_SKETCH_MIN_VALUE_ * qExp((iBucket - 0.5) * mdLogGrowth));
+}
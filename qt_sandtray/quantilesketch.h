@@ -0,0 +1,36 @@
+#ifndef QUANTILESKETCH_H
+#define QUANTILESKETCH_H
+
+#include <QtCore>
+#include <qmath.h>
+
+const float _SKETCH_MIN_VALUE_ = 0.001f;            // values at or below this share the first bucket
+const float _SKETCH_PRECISION_ = 0.01f;             // relative error of a quantile - buckets grow by 2x this
+const int _SKETCH_BUCKETS_ = 2048;                  // covers up to ~1e14 at the above precision
+
+// bounded memory quantile estimate of a non-negative series - a histogram with logarithmically sized buckets
+// any quantile can be read at any time without keeping the values; not thread safe on its own
+class QuantileSketch
+{
+public:
+    QuantileSketch();
+
+    void add(float flValue);
+    void clear();
+
+    int getCount() const;
+    float getQuantile(float flQuantile) const;
+    QList<float> getQuantiles(QList<float> flListQuantiles) const;
+
+private:
+    int getBucket(float flValue) const;
+    float getBucketValue(int iBucket) const;
+
+    QVector<int> miCounts;          // number of values in each bucket
+    int miCount;
+    float mflMin;                   // exact extremes, so the end quantiles are never outside the data
+    float mflMax;
+    double mdLogGrowth;             // log of the ratio between neighbouring bucket bounds
+};
+
+#endif // QUANTILESKETCH_H
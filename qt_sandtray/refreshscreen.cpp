@@ -1,41 +1,83 @@
-#include "refreshscreen.h"
-
-// this is small class used as a thread to force the screen to update at times we specify
-// it's lined to gameData on signals/slots to force the start and stop from around the game
-RefreshScreen::RefreshScreen(QGraphicsScene &sceneIn, GameData &currData)
-{
-    mainScene = &sceneIn;
-    mGameData = &currData;
-
-    mbRun = false;
-}
-
-void RefreshScreen::start()
-{
-    mbRun = false;
-}
-
-void RefreshScreen::startUpdate()
-{
-    mbRun = true;
-
-    while(mbRun)
-    {
-        mainScene->update();
-
-        if (!mGameData->getAnyCategoryFeedback() && !mGameData->getAnyRobotMoving())
-            mbRun = false;
-    }
-}
-
-void RefreshScreen::stopUpdate()
-{
-    mbRun = false;
-}
-
-void RefreshScreen::killThread()
-{
-    mbRun = false;
-
-    emit finished();    // kills the thread
-}
+#include "refreshscreen.h"
+
+// this is small class used to force the screen to update at times we specify
+// it's linked to gameData on signals/slots to force the start and stop from around the game
+// it lives on the GUI thread and asks for the animated items to be redrawn at a fixed rate, only while feedback or a robot move is running
+RefreshScreen::RefreshScreen(QGraphicsScene &sceneIn, GameData &currData)
+{
+    mainScene = &sceneIn;
+    mGameData = &currData;
+
+    mFrameTimer = new QTimer(this);
+    mFrameTimer->setInterval(_FRAME_INTERVAL_MS_);
+    connect(mFrameTimer, SIGNAL(timeout()), this, SLOT(nextFrame()));
+
+    miFrameCount = 0;
+    miRunFrames = 0;
+}
+
+void RefreshScreen::start()
+{
+    mFrameTimer->stop();
+}
+
+void RefreshScreen::startUpdate()
+{
+    if (mFrameTimer->isActive())
+        return;                     // already animating - the running timer covers the new animation too
+
+    miRunFrames = 0;
+    mFrameIntervals.clear();
+    mFrameClock.start();
+    mFrameTimer->start();
+    nextFrame();                    // first frame now rather than one interval late
+}
+
+// one animation has finished - keep going if another is still running
+void RefreshScreen::stopUpdate()
+{
+    if (mFrameTimer->isActive())
+    {
+        emit frameDue();            // final frame so the end state is drawn
+        stopIfIdle();
+    }
+}
+
+void RefreshScreen::killThread()
+{
+    mFrameTimer->stop();
+
+    emit finished();
+}
+
+void RefreshScreen::nextFrame()
+{
+    if (miRunFrames > 0)
+        mFrameIntervals.add(mFrameClock.nsecsElapsed() / 1000000.0f);
+
+    mFrameClock.restart();
+    miFrameCount++;
+    miRunFrames++;
+
+    emit frameDue();
+    stopIfIdle();
+}
+
+void RefreshScreen::stopIfIdle()
+{
+    if (!mGameData->getAnyCategoryFeedback() && !mGameData->getAnyRobotMoving())
+    {
+        mFrameTimer->stop();
+
+        if (mGameData->getPerformanceStats())
+            reportStatistics();
+    }
+}
+
+// frame pacing of the animation that just finished
+void RefreshScreen::reportStatistics()
+{
+    qDebug() << "Refresh:" << miRunFrames << "frames," << miFrameCount << "total, interval mean"
+             << mFrameIntervals.getMean() << "ms, jitter" << mFrameIntervals.getStdDev()
+             << "ms, min" << mFrameIntervals.getMin() << "ms, max" << mFrameIntervals.getMax() << "ms";
+}
@@ -1,35 +1,48 @@
-#ifndef REFRESHSCREEN_H
-#define REFRESHSCREEN_H
-
-#include <QObject>
-#include <QtGui>
-#include <QGraphicsItem>
-
-#include "gamedata.h"
-
-class RefreshScreen : public QObject
-{
-    Q_OBJECT
-
-public:
-    RefreshScreen(QGraphicsScene &sceneIn, GameData &currData);
-
-signals:
-    void finished();
-    void error(QString err);
-
-public slots:
-    void start();
-    void startUpdate();
-    void stopUpdate();
-    void killThread();
-
-private:
-    QGraphicsScene* mainScene;
-    GameData* mGameData;
-
-    QMutex mutex;                   // mutex for concurrent access
-    bool mbRun;
-};
-
-#endif // REFRESHSCREEN_H
+#ifndef REFRESHSCREEN_H
+#define REFRESHSCREEN_H
+
+#include <QObject>
+#include <QtGui>
+#include <QGraphicsItem>
+
+#include "gamedata.h"
+#include "runningstats.h"
+
+const int _FRAME_INTERVAL_MS_ = 16;                 // forced refresh rate while animating - ~60Hz
+
+class RefreshScreen : public QObject
+{
+    Q_OBJECT
+
+public:
+    RefreshScreen(QGraphicsScene &sceneIn, GameData &currData);
+
+signals:
+    void frameDue();                // redraw whatever is animating
+    void finished();
+    void error(QString err);
+
+public slots:
+    void start();
+    void startUpdate();
+    void stopUpdate();
+    void killThread();
+
+private slots:
+    void nextFrame();
+
+private:
+    void stopIfIdle();
+    void reportStatistics();
+
+    QGraphicsScene* mainScene;
+    GameData* mGameData;
+
+    QTimer* mFrameTimer;            // ticks on the GUI thread only while something is animating
+    QElapsedTimer mFrameClock;      // time since the last frame, for the interval/jitter stats
+    int miFrameCount;               // frames forced since the app started
+    int miRunFrames;                // frames forced in the current animation
+    RunningStats mFrameIntervals;   // ms between frames in the current animation - std dev is the jitter
+};
+
+#endif // REFRESHSCREEN_H
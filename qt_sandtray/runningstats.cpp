@@ -0,0 +1,97 @@
+#include "runningstats.h"
+
+RunningStats::RunningStats(int iWindow)
+{
+    mflRecent.resize(qMax(iWindow, 1));
+    clear();
+}
+
+void RunningStats::add(float flValue)
+{
+    miCount++;
+
+    double dDelta = flValue - mdMean;
+    mdMean += dDelta / miCount;
+    mdSumSquares += dDelta * (flValue - mdMean);
+
+    if (miCount == 1)
+    {
+        mflMin = flValue;
+        mflMax = flValue;
+    }
+    else
+    {
+        mflMin = qMin(mflMin, flValue);
+        mflMax = qMax(mflMax, flValue);
+    }
+
+    mflRecent[miNextSlot] = flValue;
+    miNextSlot = (miNextSlot + 1) % mflRecent.size();
+}
+
+void RunningStats::clear()
+{
+    miCount = 0;
+    mdMean = 0;
+    mdSumSquares = 0;
+    mflMin = 0;
+    mflMax = 0;
+    miNextSlot = 0;
+}
+
+int RunningStats::getCount() const
+{
+    return miCount;
+}
+bool RunningStats::isEmpty() const
+{
+    return miCount == 0;
+}
+
+// 0 if nothing added, same as the old list average
+float RunningStats::getMean() const
+{
+    return float(mdMean);
+}
+
+// sample variance - 0 until there are two values
+float RunningStats::getVariance() const
+{
+    if (miCount < 2)
+        return 0;
+
+    return float(mdSumSquares / (miCount - 1));
+}
+float RunningStats::getStdDev() const
+{
+    return float(qSqrt(getVariance()));
+}
+
+float RunningStats::getMin() const
+{
+    return mflMin;
+}
+float RunningStats::getMax() const
+{
+    return mflMax;
+}
+
+float RunningStats::getLast(float flIfEmpty) const
+{
+    if (miCount == 0)
+        return flIfEmpty;
+
+    return mflRecent.at((miNextSlot + mflRecent.size() - 1) % mflRecent.size());
+}
+
+// most recent values, newest first - at most the window size
+QList<float> RunningStats::getRecent() const
+{
+    QList<float> flReturn;
+    int iKept = qMin(miCount, mflRecent.size());
+
+    for (int i = 1; i <= iKept; i++)
+        flReturn.append(mflRecent.at((miNextSlot + mflRecent.size() - i) % mflRecent.size()));
+
+    return flReturn;
+}
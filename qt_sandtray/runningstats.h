@@ -0,0 +1,40 @@
+#ifndef RUNNINGSTATS_H
+#define RUNNINGSTATS_H
+
+#include <QtCore>
+#include <qmath.h>
+
+const int _RECENT_WINDOW_ = 256;                    // number of most recent values kept by RunningStats
+
+// streaming count/mean/variance/min/max of a series (Welford's method), plus a ring of the most recent values
+// constant time to add or query and constant memory however many values are added - not thread safe on its own
+class RunningStats
+{
+public:
+    RunningStats(int iWindow = _RECENT_WINDOW_);
+
+    void add(float flValue);
+    void clear();
+
+    int getCount() const;
+    bool isEmpty() const;
+    float getMean() const;
+    float getVariance() const;
+    float getStdDev() const;
+    float getMin() const;
+    float getMax() const;
+    float getLast(float flIfEmpty) const;
+    QList<float> getRecent() const;
+
+private:
+    int miCount;
+    double mdMean;
+    double mdSumSquares;            // sum of squared differences from the running mean
+    float mflMin;
+    float mflMax;
+
+    QVector<float> mflRecent;       // ring buffer of the last values added
+    int miNextSlot;                 // where the next value goes in the ring
+};
+
+#endif // RUNNINGSTATS_H
@@ -0,0 +1,149 @@
+#include "spatialgrid.h"
+
+SpatialGrid::SpatialGrid()
+{
+    miCellSize = _GRID_CELL_SIZE_;
+    miColumns = 0;
+    miRows = 0;
+}
+
+// size the grid to cover the given area - existing items are re-bucketed into the new cells
+void SpatialGrid::setBounds(QRect rBounds, int iCellSize)
+{
+    mrBounds = rBounds;
+    miCellSize = qMax(iCellSize, 1);
+    miColumns = qMax((rBounds.width() + miCellSize - 1) / miCellSize, 1);
+    miRows = qMax((rBounds.height() + miCellSize - 1) / miCellSize, 1);
+
+    mCells.clear();
+    mCells.resize(miColumns * miRows);
+
+    QHash<int, QRect>::const_iterator it;
+    for (it = mItems.constBegin(); it != mItems.constEnd(); ++it)
+        addToCells(it.key(), it.value());
+}
+
+// add an item, or move it if it is already in the grid
+void SpatialGrid::insert(int iId, QRect rItem)
+{
+    if (mItems.contains(iId))
+    {
+        QRect rOld = mItems.value(iId);
+
+        if (rOld == rItem)
+            return;
+
+        removeFromCells(iId, rOld);
+    }
+
+    mItems.insert(iId, rItem);
+    addToCells(iId, rItem);
+}
+
+void SpatialGrid::remove(int iId)
+{
+    if (mItems.contains(iId))
+    {
+        removeFromCells(iId, mItems.value(iId));
+        mItems.remove(iId);
+    }
+}
+
+QRect SpatialGrid::getItemBounds(int iId) const
+{
+    return mItems.value(iId);
+}
+
+// ids of all items overlapping the area, in ascending order
+QList<int> SpatialGrid::query(QRect rArea) const
+{
+    QList<int> iReturn;
+
+    if (mCells.isEmpty())
+    {
+        // no bounds set yet, so fall back to testing everything
+        QHash<int, QRect>::const_iterator it;
+        for (it = mItems.constBegin(); it != mItems.constEnd(); ++it)
+        {
+            if (overlaps(it.value(), rArea))
+                iReturn.append(it.key());
+        }
+    }
+    else
+    {
+        int iFirstCol, iLastCol, iFirstRow, iLastRow;
+        getCellRange(rArea, iFirstCol, iLastCol, iFirstRow, iLastRow);
+
+        for (int iRow = iFirstRow; iRow <= iLastRow; iRow++)
+        {
+            for (int iCol = iFirstCol; iCol <= iLastCol; iCol++)
+            {
+                foreach (int iId, mCells[(iRow * miColumns) + iCol])
+                {
+                    // an item spanning several cells is seen more than once
+                    if (!iReturn.contains(iId) && overlaps(mItems.value(iId), rArea))
+                        iReturn.append(iId);
+                }
+            }
+        }
+    }
+
+    qSort(iReturn);
+    return iReturn;
+}
+
+// bounds of an item centred on a point - same integer maths the game has always used for its overlap tests
+QRect SpatialGrid::boundsAround(QPointF qpfCentre, QSize qsSize, int iMargin)
+{
+    int iLeft = int(qpfCentre.x()) - (qsSize.width() / 2) - iMargin;
+    int iRight = int(qpfCentre.x()) + (qsSize.width() / 2) + iMargin;
+    int iTop = int(qpfCentre.y()) - (qsSize.height() / 2) - iMargin;
+    int iBottom = int(qpfCentre.y()) + (qsSize.height() / 2) + iMargin;
+
+    return QRect(iLeft, iTop, iRight - iLeft, iBottom - iTop);
+}
+
+// strict overlap (proof by contradiction) - touching edges do not count
+bool SpatialGrid::overlaps(QRect rA, QRect rB)
+{
+    return rA.x() < rB.x() + rB.width() && rA.x() + rA.width() > rB.x() &&
+           rA.y() < rB.y() + rB.height() && rA.y() + rA.height() > rB.y();
+}
+
+void SpatialGrid::addToCells(int iId, QRect rItem)
+{
+    if (mCells.isEmpty())
+        return;
+
+    int iFirstCol, iLastCol, iFirstRow, iLastRow;
+    getCellRange(rItem, iFirstCol, iLastCol, iFirstRow, iLastRow);
+
+    for (int iRow = iFirstRow; iRow <= iLastRow; iRow++)
+        for (int iCol = iFirstCol; iCol <= iLastCol; iCol++)
+            mCells[(iRow * miColumns) + iCol].append(iId);
+}
+
+void SpatialGrid::removeFromCells(int iId, QRect rItem)
+{
+    if (mCells.isEmpty())
+        return;
+
+    int iFirstCol, iLastCol, iFirstRow, iLastRow;
+    getCellRange(rItem, iFirstCol, iLastCol, iFirstRow, iLastRow);
+
+    for (int iRow = iFirstRow; iRow <= iLastRow; iRow++)
+        for (int iCol = iFirstCol; iCol <= iLastCol; iCol++)
+            mCells[(iRow * miColumns) + iCol].removeOne(iId);
+}
+
+// cells touched by an area - anything outside the grid is clamped to the edge cells so it can still be found
+void SpatialGrid::getCellRange(QRect rArea, int &iFirstCol, int &iLastCol, int &iFirstRow, int &iLastRow) const
+{
+    int iRight = rArea.x() + qMax(rArea.width(), 1) - 1;
+    int iBottom = rArea.y() + qMax(rArea.height(), 1) - 1;
+
+    iFirstCol = qBound(0, qFloor(qreal(rArea.x() - mrBounds.x()) / miCellSize), miColumns - 1);
+    iLastCol = qBound(0, qFloor(qreal(iRight - mrBounds.x()) / miCellSize), miColumns - 1);
+    iFirstRow = qBound(0, qFloor(qreal(rArea.y() - mrBounds.y()) / miCellSize), miRows - 1);
+    iLastRow = qBound(0, qFloor(qreal(iBottom - mrBounds.y()) / miCellSize), miRows - 1);
+}
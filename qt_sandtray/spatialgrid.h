@@ -0,0 +1,40 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <QtGui>
+#include <qmath.h>
+
+const int _GRID_CELL_SIZE_ = 128;                   // size of a spatial grid cell in pixels
+
+// uniform grid over the scene, used to find which items overlap an area without testing every item
+// each item is stored against every cell its bounds touch; items off the grid are clamped into the edge cells
+class SpatialGrid
+{
+public:
+    SpatialGrid();
+
+    void setBounds(QRect rBounds, int iCellSize = _GRID_CELL_SIZE_);
+
+    void insert(int iId, QRect rItem);
+    void remove(int iId);
+    QRect getItemBounds(int iId) const;
+
+    QList<int> query(QRect rArea) const;
+
+    static QRect boundsAround(QPointF qpfCentre, QSize qsSize, int iMargin = 0);
+    static bool overlaps(QRect rA, QRect rB);
+
+private:
+    void addToCells(int iId, QRect rItem);
+    void removeFromCells(int iId, QRect rItem);
+    void getCellRange(QRect rArea, int &iFirstCol, int &iLastCol, int &iFirstRow, int &iLastRow) const;
+
+    QRect mrBounds;                 // area of the scene covered by the grid
+    int miCellSize;                 // width and height of one cell in pixels
+    int miColumns;
+    int miRows;
+    QVector<QList<int> > mCells;    // ids of the items touching each cell - row major
+    QHash<int, QRect> mItems;       // bounds of every item in the grid
+};
+
+#endif // SPATIALGRID_H